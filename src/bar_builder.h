@@ -0,0 +1,200 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "seqlock.h"
+#include "ring_buffer.h"
+
+typedef double DATE;
+#include <include/trading.h>
+
+namespace zorro {
+
+/**
+ * @brief Builds OHLCV bars of one period from live trade prints.
+ *
+ * Fed by TradePrint on the RApi callback thread, read by BrokerHistory2 on the Zorro thread.
+ * Bars are aligned to multiples of the period like the history server bars and stamped with
+ * their end time. The first bar is partial because the builder starts in the middle of it, it is
+ * never served. Completed bars are kept in a ring, so only the most recent MAX_BARS are covered.
+ *
+ * When the print stream is interrupted (unsubscribe, eviction, resubscribe, a broken connection) the
+ * bars around the gap are missing prints. interrupt() drops the coverage, the next print starts over
+ * with a new partial bar and coverage resumes after it.
+ */
+class BarBuilder
+{
+public:
+    static constexpr uint32_t MAX_BARS = 1024;
+
+private:
+    struct Bar
+    {
+        uint64_t end_ = 0;      // ns since epoch
+        double open_ = NAN;
+        double high_ = NAN;
+        double low_ = NAN;
+        double close_ = NAN;
+        double volume_ = 0.;
+    };
+
+    const uint32_t minutes_;
+    const uint64_t period_ns_;
+    SeqLock<Bar> current_;
+    SeqRing<Bar, MAX_BARS> bars_;
+    std::atomic<uint64_t> first_end_{0};
+    std::atomic<uint32_t> interrupts_{0};   // incremented by interrupt(), any thread
+    std::atomic<uint32_t> restarted_{0};    // interrupts_ the writer has started over for
+
+public:
+    explicit BarBuilder(uint32_t minutes) noexcept
+        : minutes_(minutes)
+        , period_ns_((uint64_t)minutes * 60 * 1000000000)
+    {}
+
+    uint32_t minutes() const noexcept { return minutes_; }
+
+    /**
+     * @brief Prints were or may have been lost. Bars are not covered until the writer started over.
+     */
+    void interrupt() noexcept { interrupts_.fetch_add(1, std::memory_order_acq_rel); }
+
+    void onTrade(uint64_t time, double price, int64_t qty) noexcept
+    {
+        auto bar = current_.load();
+        auto interrupts = interrupts_.load(std::memory_order_acquire);
+        bool restart = interrupts != restarted_.load(std::memory_order_relaxed);
+        if (bar.end_ == 0 || time >= bar.end_ || restart)
+        {
+            if (bar.end_ && !restart)
+            {
+                bars_.push(bar);
+            }
+            bar.end_ = (time / period_ns_ + 1) * period_ns_;
+            bar.open_ = bar.high_ = bar.low_ = bar.close_ = price;
+            bar.volume_ = (double)qty;
+            if (!first_end_.load(std::memory_order_relaxed) || restart)
+            {
+                // the new bar is partial, coverage starts with its end
+                first_end_.store(bar.end_, std::memory_order_release);
+                restarted_.store(interrupts, std::memory_order_release);
+            }
+        }
+        else if (time + period_ns_ < bar.end_)
+        {
+            // late print of an already completed bar
+            return;
+        }
+        else
+        {
+            bar.high_ = std::max(bar.high_, price);
+            bar.low_ = std::min(bar.low_, price);
+            bar.close_ = price;
+            bar.volume_ += (double)qty;
+        }
+        current_.store(bar);
+    }
+
+    /**
+     * @brief Time (seconds) from which every bar is known to the builder. Bars ending after it can be served.
+     */
+    int64_t coveredFrom() const noexcept
+    {
+        if (restarted_.load(std::memory_order_acquire) != interrupts_.load(std::memory_order_acquire))
+        {
+            // interrupted, no print since
+            return INT64_MAX;
+        }
+        auto first_end = first_end_.load(std::memory_order_acquire);
+        if (!first_end)
+        {
+            return INT64_MAX;
+        }
+
+        uint64_t covered = first_end;
+        auto head = bars_.head();
+        if (head > MAX_BARS)
+        {
+            // older bars were dropped, coverage starts with the oldest retained bar
+            bars_.readSince(head - MAX_BARS, 1, [&covered, this](uint64_t, const Bar &bar) {
+                covered = std::max(covered, bar.end_ - period_ns_);
+            });
+        }
+        return (int64_t)(covered / 1000000000);
+    }
+
+    /**
+     * @brief Copy the completed bars ending in (start, end] newest first, the Zorro history order.
+     * @param start, end, now seconds since epoch
+     * @return number of bars copied
+     */
+    int copy(int64_t start, int64_t end, int64_t now, int max_bars, T6 *out) const noexcept
+    {
+        auto covered = coveredFrom();
+        if (covered == INT64_MAX)
+        {
+            return 0;
+        }
+
+        auto lower = (uint64_t)std::max(start, covered) * 1000000000;
+        auto upper = (uint64_t)end * 1000000000;
+        auto now_ns = (uint64_t)now * 1000000000;
+        uint64_t last_end = UINT64_MAX;
+        int n = 0;
+
+        auto emit = [&](const Bar &bar) {
+            if (bar.end_ >= last_end || bar.end_ > upper)
+            {
+                return true;    // already copied or newer than requested
+            }
+            if (bar.end_ <= lower || n >= max_bars)
+            {
+                return false;
+            }
+            auto &tick = out[n++];
+            tick.time = (DATE)(bar.end_ / 1000000000) / 86400. + 25569.;
+            tick.fOpen = (float)bar.open_;
+            tick.fHigh = (float)bar.high_;
+            tick.fLow = (float)bar.low_;
+            tick.fClose = (float)bar.close_;
+            tick.fVal = 0.f;
+            tick.fVol = (float)bar.volume_;
+            last_end = bar.end_;
+            return true;
+        };
+
+        // the bar in progress is complete once its end time has passed
+        auto current = current_.load();
+        if (current.end_ && current.end_ <= now_ns)
+        {
+            emit(current);
+        }
+        bars_.readReverse([&emit](uint64_t, const Bar &bar) { return emit(bar); });
+        return n;
+    }
+};
+
+}   // namespace zorro
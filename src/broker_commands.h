@@ -0,0 +1,228 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+// Plugin specific brokerCommand codes and the structs they exchange with the script.
+// Structs only use var (double) and int fields so they can be mirrored in lite-C.
+
+namespace zorro {
+
+enum PluginCommand : int
+{
+    SET_LOG_LEVEL = 2000,           // parameter: spdlog level
+    SET_DAY_ORDER = 2001,           // parameter: 1 use DAY instead of IOC as default order type
+    GET_NOTIFY_STATS = 2002,        // parameter: NotifyStats*
+    SET_MARKET_DEPTH = 2003,        // parameter: 1 subscribe market depth for assets subscribed afterwards
+    GET_TRADE_PRINTS = 2004,        // parameter: TradeQuery*, asset set by SET_SYMBOL
+    SUBSCRIBE_ASSETS = 2005,        // parameter: char* asset list, returns number of assets ready
+    GET_READY_LATENCY = 2006,       // returns ms from subscription to ready of the SET_SYMBOL asset
+    GET_WAIT_STATS = 2007,          // parameter: WaitStats[7], one entry per wait site
+    GET_INGRESS_STATS = 2008,       // parameter: IngressStatsInfo*
+    GET_LATENCY = 2009,             // parameter: LatencyInfo[3], asset set by SET_SYMBOL
+    UNSUBSCRIBE_ASSET = 2010,       // parameter: char* asset, returns remaining references
+    GET_SUBSCRIPTIONS = 2011,       // parameter: SubscriptionQuery*
+    GET_SESSION_STATS = 2012,       // parameter: SessionInfo*, asset set by SET_SYMBOL
+    GET_QUOTES = 2013,              // parameter: QuoteQuery*, returns number of ready quotes
+    SET_DAILY_STATS = 2014,         // parameter: 1 subscribe session statistics for assets subscribed afterwards
+    GET_DAILY_STATS = 2015,         // parameter: DailyStatsInfo*, asset set by SET_SYMBOL
+    GET_STREAM_STATS = 2016,        // parameter: StreamStatsInfo*
+    GET_CONSISTENT_QUOTES = 2017,   // parameter: CutQuery*, returns 1 if all legs are from one instant
+    SET_ASYNC_ORDERS = 2018,        // parameter: 1 BrokerBuy2 returns a provisional trade id without waiting for the order
+};
+
+// plugin specific SET_PRICETYPE values, both derived from the best bid and ask
+enum PluginPriceType : int
+{
+    PRICETYPE_MID = 10,
+    PRICETYPE_MICROPRICE = 11,
+};
+
+struct NotifyStats
+{
+    double updates;     // market data updates received
+    double wakeups;     // WM_APP+1 wakeups posted to Zorro
+};
+
+struct WaitStats
+{
+    double calls;
+    double blocked;     // waits that ended up blocking on the event
+    double wait_ms;     // total wall time spent waiting
+    double max_wait_ms;
+    double cpu_ms;      // CPU time of the Zorro thread while waiting
+};
+
+struct IngressStatsInfo
+{
+    double md_events;
+    double pnl_events;
+    double stalls;          // pushes that found the queue full, only with RithmicCallbackQueue=1
+    double callbacks;       // market data callbacks
+    double callback_avg_us; // average time a market data callback held the R|API thread
+    double callback_max_us;
+};
+
+// one entry per stage: exchange -> callback, callback -> publish, publish -> BrokerAsset
+struct LatencyInfo
+{
+    double count;
+    double mean_us;
+    double p50_us;
+    double p90_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+};
+
+struct SubscriptionInfo
+{
+    char asset[32];
+    int refs;
+    int subscribed;     // 1 live market data subscription
+    double updates;     // market data updates received
+    double rate;        // updates per second while subscribed
+    double idle;        // seconds since last used by BrokerAsset
+};
+
+struct SubscriptionQuery
+{
+    SubscriptionInfo *infos;    // caller buffer
+    int max_infos;
+};
+
+struct SessionInfo
+{
+    double start;       // first print of the session, UTC OLE DATE
+    double vwap;
+    double high;
+    double low;
+    double trades;
+    double volume;
+    double buy_volume;  // volume of prints with a buy aggressor
+    double sell_volume; // volume of prints with a sell aggressor
+    double delta;       // buy_volume - sell_volume
+};
+
+// values not received yet are NaN, open_interest -1
+struct DailyStatsInfo
+{
+    double open;
+    double high;
+    double low;
+    double close;       // previous session close
+    double settlement;
+    double open_interest;
+    double time;        // last update, UTC OLE DATE
+};
+
+struct StreamStatsInfo
+{
+    double prints;          // trade print callbacks received
+    double saved_prints;    // estimated trade print callbacks not received because MD_PRINTS was left out
+    int trimmed;            // live subscriptions without MD_PRINTS
+    int resubscribes;       // resubscriptions after SET_PRICETYPE/SET_VOLTYPE changes
+};
+
+// doubles first. 32 bit builds get an explicit pad, MSVC would round 36 bytes up to 40 while lite-C packs
+// the array with a 36 byte stride, so every record after the first would be read from the wrong place.
+struct QuoteRecord
+{
+    double price;
+    double spread;
+    double volume;
+    char *asset;        // looked up while handle is -1
+    int handle;         // set by the plugin, keep it to skip the lookup on the next call
+    int ready;          // 1 price, spread and volume are filled
+#if defined(_WIN32) && !defined(_WIN64)
+    int pad;
+#endif
+};
+static_assert(offsetof(QuoteRecord, asset) == 24, "QuoteRecord layout differs from lite-C");
+static_assert(offsetof(QuoteRecord, handle) == 24 + sizeof(void*), "QuoteRecord layout differs from lite-C");
+static_assert(offsetof(QuoteRecord, ready) == 28 + sizeof(void*), "QuoteRecord layout differs from lite-C");
+static_assert(sizeof(QuoteRecord) == 40, "QuoteRecord has implicit padding");
+
+struct QuoteQuery
+{
+    QuoteRecord *quotes;    // caller buffer
+    int n_quotes;
+};
+
+// doubles first, with an explicit pad in 32 bit builds for the same reason as QuoteRecord (60 bytes of fields)
+struct CutLeg
+{
+    double bid;
+    double ask;
+    double bid_size;
+    double ask_size;
+    double last;        // last trade price
+    double seq;         // global market data sequence of the newest update of this leg
+    char *asset;        // looked up while handle is -1
+    int handle;         // set by the plugin, keep it to skip the lookup on the next call
+    int ready;          // 1 the leg is filled
+#if defined(_WIN32) && !defined(_WIN64)
+    int pad;
+#endif
+};
+static_assert(offsetof(CutLeg, asset) == 48, "CutLeg layout differs from lite-C");
+static_assert(offsetof(CutLeg, handle) == 48 + sizeof(void*), "CutLeg layout differs from lite-C");
+static_assert(offsetof(CutLeg, ready) == 52 + sizeof(void*), "CutLeg layout differs from lite-C");
+static_assert(sizeof(CutLeg) == 64, "CutLeg has implicit padding");
+
+struct CutQuery
+{
+    double seq;         // cut point, the global sequence every leg is current as of
+    CutLeg *legs;       // caller buffer, at most 16 legs
+    int n_legs;
+    int retries;        // collects that had to be repeated because a leg changed
+};
+static_assert(offsetof(CutQuery, legs) == 8, "CutQuery layout differs from lite-C");
+static_assert(offsetof(CutQuery, n_legs) == 8 + sizeof(void*), "CutQuery layout differs from lite-C");
+static_assert(offsetof(CutQuery, retries) == 12 + sizeof(void*), "CutQuery layout differs from lite-C");
+
+struct TradeTick
+{
+    double seq;         // sequence number of the print
+    double time;        // exchange time, UTC OLE DATE with second resolution
+    double price;
+    double size;
+    int side;           // aggressor side, 0 buy, 1 sell, 2 unknown
+    int nanos;          // nanoseconds within the second of time
+};
+
+// since_seq first, lite-C doesn't align a double after a pointer and two ints to 8 bytes like MSVC does.
+// The 4 bytes of tail padding of 32 bit builds don't matter, the query is only passed by pointer.
+struct TradeQuery
+{
+    double since_seq;   // last_n == 0: copy all prints with seq >= since_seq
+    TradeTick *ticks;   // caller buffer
+    int max_ticks;      // capacity of ticks
+    int last_n;         // > 0: copy the last n prints
+};
+static_assert(offsetof(TradeQuery, ticks) == 8, "TradeQuery layout differs from lite-C");
+static_assert(offsetof(TradeQuery, max_ticks) == 8 + sizeof(void*), "TradeQuery layout differs from lite-C");
+static_assert(offsetof(TradeQuery, last_n) == 12 + sizeof(void*), "TradeQuery layout differs from lite-C");
+static_assert(sizeof(TradeQuery) == 24, "TradeQuery size changed");
+
+}   // namespace zorro
@@ -36,15 +36,95 @@ RithmicClient::RithmicClient(std::string user)
 {
     system_config_.env[7] = (char*)env_user_.data();
     ticks_.reserve(15000);
+    notifier_.setMinInterval(Config::get().notify_interval_ms_);
+    waiter_.configure(Config::get().wait_spin_count_, Config::get().wait_yield_count_, Config::get().wait_block_ms_);
+    use_ingress_ = Config::get().callback_queue_;
+    if (!Config::get().record_path_.empty())
+    {
+        recorder_ = std::make_unique<TickRecorder>(Config::get().record_path_, [this](uint32_t handle) { return symbols_[handle].spec_.symbol_; });
+    }
+    if (!Config::get().ref_data_cache_.empty())
+    {
+        ref_data_cache_.load(Config::get().ref_data_cache_, Config::get().ref_data_expiry_h_ * 3600ull);
+    }
+    if (!Config::get().provisional_ids_.empty())
+    {
+        provisional_ids_.load(Config::get().provisional_ids_, get_timestamp() / 1000);
+    }
 }
 
 RithmicClient::~RithmicClient()
 {
+    SPDLOG_INFO("MD updates received: {}, Zorro wakeups posted: {}", notifier_.updates(), notifier_.wakeups());
+    for (uint8_t i = 0; i < (uint8_t)WaitSite::__count__; ++i)
+    {
+        auto &stats = waiter_.stats((WaitSite)i);
+        auto calls = stats.calls_.load(std::memory_order_relaxed);
+        if (calls)
+        {
+            SPDLOG_INFO("Wait {}: calls={} blocked={} total={}us max={}us cpu={}us", to_string((WaitSite)i), calls,
+                stats.blocked_.load(std::memory_order_relaxed), stats.wait_us_.load(std::memory_order_relaxed),
+                stats.max_wait_us_.load(std::memory_order_relaxed), stats.cpu_us_.load(std::memory_order_relaxed));
+        }
+    }
     if (engine_)
     {
         int iIgnored;
         engine_->logout(&iIgnored);
     }
+    stopIngress();
+    saveRefData();
+    {
+        std::lock_guard lock(orders_mutex_);
+        provisional_ids_.save();
+    }
+    if (recorder_)
+    {
+        recorder_->stop();
+    }
+    for (uint32_t i = 0; i < n_symbols_.load(std::memory_order_acquire); ++i)
+    {
+        auto &symbol = symbols_[i];
+        SPDLOG_INFO("{} updates={} rate={:.1f}/s refs={} subscribed={} stale={}", symbol.spec_.symbol_, symbol.updates_.load(std::memory_order_relaxed),
+            updateRate(symbol), symbol.ref_count_, symbol.subscribed_.load(std::memory_order_relaxed), symbol.stale_count_);
+        if (!symbol.latency_)
+        {
+            continue;
+        }
+        for (uint8_t j = 0; j < (uint8_t)LatencyStage::__count__; ++j)
+        {
+            auto &histogram = (*symbol.latency_)[(LatencyStage)j];
+            if (histogram.count())
+            {
+                SPDLOG_INFO("{} {} latency: n={} mean={}us p50={}us p90={}us p99={}us p99.9={}us max={}us", symbol.spec_.symbol_, to_string((LatencyStage)j),
+                    histogram.count(), histogram.mean() / 1000., histogram.percentile(0.5) / 1000., histogram.percentile(0.9) / 1000.,
+                    histogram.percentile(0.99) / 1000., histogram.percentile(0.999) / 1000., histogram.max() / 1000.);
+            }
+        }
+    }
+    SPDLOG_INFO("MD events: {}, PnL events: {}, deferred cancels: {}, queue stalls: {}, applied inline: {}, MD callbacks: {} avg={}ns max={}ns",
+        ingress_stats_.md_events_.load(std::memory_order_relaxed), ingress_stats_.pnl_events_.load(std::memory_order_relaxed),
+        ingress_stats_.cancels_.load(std::memory_order_relaxed), ingress_stats_.stalls_.load(std::memory_order_relaxed),
+        ingress_stats_.inline_events_.load(std::memory_order_relaxed),
+        ingress_stats_.callbacks_.load(std::memory_order_relaxed),
+        ingress_stats_.callback_ns_.load(std::memory_order_relaxed) / std::max<uint64_t>(1, ingress_stats_.callbacks_.load(std::memory_order_relaxed)),
+        ingress_stats_.max_callback_ns_.load(std::memory_order_relaxed));
+    auto order_reports = order_report_stats_.callbacks_.load(std::memory_order_relaxed);
+    auto order_report_ns = order_report_stats_.callback_ns_.load(std::memory_order_relaxed) / std::max<uint64_t>(1, order_reports);
+    SPDLOG_INFO("Order reports: {} avg={}ns max={}ns (~{:.0f} reports/s), order slots: {}/{} live: {} recycled: {} retired: {}", order_reports, order_report_ns,
+        order_report_stats_.max_callback_ns_.load(std::memory_order_relaxed), 1e9 / std::max<uint64_t>(1, order_report_ns), orders_.size(), orders_.capacity(),
+        orders_.live(), orders_.recycled(), orders_retired_);
+    for (auto async : {false, true})
+    {
+        auto entries = order_report_stats_.entries_[async].load(std::memory_order_relaxed);
+        if (entries)
+        {
+            SPDLOG_INFO("{} order entries: {} avg={}us", async ? "Asynchronous" : "Blocking", entries,
+                order_report_stats_.entry_ns_[async].load(std::memory_order_relaxed) / entries / 1000);
+        }
+    }
+    auto streams = streamStats();
+    SPDLOG_INFO("Trade prints: {:.0f}, saved by trimmed subscriptions: ~{:.0f}, stream resubscribes: {}", streams.prints, streams.saved_prints, streams.resubscribes);
 }
 
 void RithmicClient::setServer(const std::string &server_name)
@@ -73,6 +153,11 @@ std::string_view RithmicClient::accountId() const noexcept
 bool RithmicClient::login(std::string password, std::string &err)
 {
     password_ = std::move(password);
+    startIngress();     // before any subscription, the ingress thread must be the only writer from the start
+    if (recorder_)
+    {
+        recorder_->start();
+    }
 
     // if (!checkAgreements(err))
     // {
@@ -109,14 +194,9 @@ bool RithmicClient::login(std::string password, std::string &err)
     }
 
     unsigned long login_status = 0;
-    while((login_status = login_status_.load(std::memory_order_relaxed).to_ulong()) < 15)
+    if (waiter_.wait(WaitSite::Login, [&]() { return (login_status = login_status_.load(std::memory_order_acquire).to_ulong()) >= 15; }) != WaitResult::Done)
     {
-        if (!BrokerProgress(1))
-        {
-            return false;
-        }
-        using namespace std::chrono_literals;
-        std::this_thread::sleep_for(1s);
+        return false;
     }
 
     if (login_status != 15)
@@ -125,12 +205,9 @@ bool RithmicClient::login(std::string password, std::string &err)
         return false;
     }
     
-    while(!account_received_.load(std::memory_order_relaxed))
+    if (waiter_.wait(WaitSite::Login, [this]() { return account_received_.load(std::memory_order_acquire); }) != WaitResult::Done)
     {
-        if (!BrokerProgress(1))
-        {
-            return false;
-        }
+        return false;
     }
 
     if (!listTradeRoutes())
@@ -143,13 +220,18 @@ bool RithmicClient::login(std::string password, std::string &err)
         return false;
     }
 
-    auto last_order_index = next_order_index_.load(std::memory_order_relaxed);
-    for (auto i = 0u; i < last_order_index; ++i)
+    for (auto i = 0u; i < orders_.size(); ++i)
     {
-        auto order = orders_[i].load(std::memory_order_relaxed);
-        if (order->order_num_ != 0)
+        auto *order = orders_.at(i);
+        if (order && order->handle_.load(std::memory_order_relaxed) && order->trade_id_)
         {
-            orders_by_id_[order->order_num_] = &orders_[i];
+            mapOrder(order->trade_id_, order->handle_.load(std::memory_order_relaxed));
+            if (order->trade_id_ >= PROVISIONAL_ID_BASE)
+            {
+                // an asynchronous order of an earlier session, recovered from its tag
+                std::lock_guard lock(orders_mutex_);
+                provisional_ids_.reserve(order->trade_id_, order->state_.load().order_num_, get_timestamp() / 1000);
+            }
         }
     }
 
@@ -185,11 +267,10 @@ bool RithmicClient::checkAgreements(std::string &err)
         return false;
     }
 
-    using namespace std::chrono_literals;
     RequestStatus status;
-    while((status = request_status_.load(std::memory_order_relaxed)) == RequestStatus::AwaitingResults)
+    if (waiter_.wait(WaitSite::Login, [&]() { return (status = request_status_.load(std::memory_order_acquire)) != RequestStatus::AwaitingResults; }) != WaitResult::Done)
     {
-        std::this_thread::sleep_for(1s);
+        return false;
     }
 
     if (status != RequestStatus::Complete)
@@ -257,6 +338,7 @@ int RithmicClient::AccountList(RApi::AccountListInfo *pInfo, void *pContext, int
         account_info_.sAccountName.pData = account_name_.data();
         account_info_.sAccountName.iDataLen = (int)account_name_.length(); 
         account_received_.store(true, std::memory_order_release);
+        waiter_.signal();
     }
     *aiCode = API_OK;
     return (OK);
@@ -302,6 +384,7 @@ int RithmicClient::TradeRouteList(RApi::TradeRouteListInfo *pInfo, void *pContex
         }
     }
     request_status_.store(RequestStatus::Complete, std::memory_order_release);
+    waiter_.signal();
     *aiCode = API_OK;
     return (OK);
 }
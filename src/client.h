@@ -29,10 +29,23 @@
 #include <string_view>
 #include <unordered_map>
 #include <chrono>
+#include <mutex>
+#include <thread>
 #include "symbol.h"
-#include "Order.h"
+#include "order_pool.h"
+#include "order_wait.h"
 #include "pnl.h"
 #include "rithmic_system_config.h"
+#include "utils.h"
+#include "notifier.h"
+#include "waiter.h"
+#include "ingress.h"
+#include "ref_data_cache.h"
+#include "provisional_ids.h"
+#include "timer_wheel.h"
+#include "symbol_index.h"
+#include "tick_recorder.h"
+#include "broker_commands.h"
 
 #include <windows.h>
 typedef double DATE;			//prerequisite for using trading.h
@@ -59,6 +72,9 @@ struct AdmCallbacks : public RApi::AdmCallbacks
 class RithmicClient : public RApi::RCallbacks
 {
     static constexpr uint32_t MAX_ORDER_NUM = 1000000;
+    // trade ids returned by asynchronous order entry, above the order numbers Rithmic assigns
+    static constexpr uint32_t PROVISIONAL_ID_BASE = ProvisionalIds::BASE;
+    static constexpr uint32_t MAX_SYMBOL_NUM = MAX_ASSETS;
 
     RithmicSystemConfig system_config_;
 
@@ -100,19 +116,64 @@ class RithmicClient : public RApi::RCallbacks
     std::atomic_bool unaccepted_agreements_received_;
     std::atomic_bool account_received_;
     std::atomic<RequestStatus> request_status_{RequestStatus::NoRequest};
-    std::atomic<uint64_t> pending_order_request_;
     bool has_unaccepted_aggreements_;
 
-    std::unordered_map<std::string, Symbol> symbols_;
-    std::unordered_map<uint32_t, std::atomic<std::shared_ptr<Order>>*> orders_by_id_;
-    std::array<std::atomic<std::shared_ptr<Order>>, MAX_ORDER_NUM> orders_;
-    std::atomic_uint_fast32_t next_order_index_;
+    // Symbols are stored contiguously and addressed by a dense handle. MD callbacks resolve
+    // the symbol from the subscription context, the name map is only used by the Zorro thread.
+    // A slot is published in n_symbols_ once subscribed and its name never changes afterwards.
+    // symbol_index_ holds the published slots for lookups by name from other threads.
+    std::array<Symbol, MAX_SYMBOL_NUM> symbols_;
+    std::atomic_uint32_t n_symbols_;
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> symbol_handles_;
+    SymbolIndex<MAX_SYMBOL_NUM> symbol_index_;
+    uint32_t n_subscribed_ = 0;     // live market data subscriptions, Zorro thread only
+    uint32_t stream_resubscribes_ = 0;  // resubscriptions by updateStreams, Zorro thread only
+    TimerWheel<512, 250> watchdog_;     // one staleness timer per subscribed symbol, Zorro thread only
+
+    // global market data sequence, incremented by the single market data writer for every applied event
+    std::atomic<uint64_t> md_seq_{0};
+    ZorroNotifier<MAX_SYMBOL_NUM> notifier_;
+    Waiter waiter_;
+    mutable std::mutex orders_mutex_;   // guards orders_by_id_ and provisional_ids_
+    std::unordered_map<uint32_t, uint32_t> orders_by_id_;     // trade id -> order handle
+    OrderPool orders_{MAX_ORDER_NUM};
+    uint32_t retire_cursor_ = 0;        // next slot checked by retireOrders, Zorro thread only
+    uint64_t next_retire_ms_ = 0;
+    uint64_t orders_retired_ = 0;
+    ProvisionalIds provisional_ids_;
+    OrderReportStats order_report_stats_;
     
     std::vector<T6> ticks_;
     size_t n_ticks_requested_ = 0;
 
     std::atomic<PnL> pnl_;
-    std::unordered_map<std::string, std::atomic<Position>> asset_position_;
+
+    // Optional ingress stage: callbacks copy their data into SPSC queues and return,
+    // the ingress thread becomes the single writer of the symbol state.
+    bool use_ingress_ = false;
+    std::atomic_bool ingress_running_{false};
+    std::atomic_bool ingress_draining_{false};  // from startIngress until the ingress thread applied its last event
+    std::atomic<uint32_t> ingress_pushing_{0};  // pushes in progress, the last drain waits for them
+    std::atomic_bool ingress_sleeping_{false};
+    HANDLE ingress_event_ = nullptr;
+    std::thread ingress_thread_;
+    std::unique_ptr<MDQueue> md_queue_;
+    std::unique_ptr<PnlQueue> pnl_queue_;
+    std::unique_ptr<CancelQueue> cancel_queue_;
+    IngressStats ingress_stats_;
+
+    // optional .t1/.t2 recorder, fed by the thread that applies market data
+    std::unique_ptr<TickRecorder> recorder_;
+
+    // reference data and price increments of previous sessions, Zorro thread only
+    RefDataCache ref_data_cache_;
+    // replies queued by RefData and PriceIncrUpdate, applied by the Zorro thread in applyRefData()
+    std::mutex ref_replies_mutex_;
+    std::vector<RefDataReply> ref_replies_;
+
+    // errors of other threads, passed to BrokerError by the Zorro thread in reportErrors()
+    std::mutex errors_mutex_;
+    std::vector<std::string> errors_;
 
 public:
     RithmicClient(std::string user);
@@ -125,11 +186,104 @@ public:
     PnL pnl() const noexcept { return pnl_.load(std::memory_order_relaxed); }
 
     bool login(std::string password, std::string &err);
-    bool getRefData(tsNCharcb &exchange, tsNCharcb &symbol);
-    bool getPriceIncInfo(tsNCharcb &exchange, tsNCharcb &symbol);
+    /**
+     * @brief Wait for the price increment of a new symbol, requesting it if no request is outstanding.
+     */
+    bool waitPriceIncrement(Symbol &symbol);
+    /**
+     * @brief Apply the queued reference data replies to their symbols. Zorro thread only.
+     */
+    void applyRefData();
+    void saveRefData();
     bool subscribe(const char* asset);
-    Symbol* getSymbol(const char* asset);
-    Symbol* getSymbol(const std::string &exchange, const std::string &ticker);
+    /**
+     * @brief Subscribe a list of assets at once and wait until all of them are ready
+     * @param assets asset names separated by ',', ';' or space
+     * @return number of assets ready before the timeout
+     */
+    uint32_t subscribeAll(std::string_view assets, uint32_t timeout_ms);
+    Symbol* getSymbol(std::string_view asset);
+
+    /**
+     * @brief Get a symbol with a live market data subscription, (re)subscribing it if necessary.
+     * Evicts the least recently used subscription when RithmicMaxSubscriptions is reached.
+     * @param add_ref add a reference, otherwise only the first use counts as a reference
+     */
+    Symbol* acquireSymbol(const char* asset, bool add_ref = false);
+
+    /**
+     * @brief Drop a reference, the market data is unsubscribed when the last reference is dropped.
+     * @return remaining references, -1 if the asset is not subscribed
+     */
+    int releaseSymbol(const char* asset);
+    int getSubscriptions(SubscriptionQuery &query) const;
+    double updateRate(const Symbol &symbol) const;
+
+    /**
+     * @brief Resubscribe the symbols whose stream mask no longer matches SET_PRICETYPE/SET_VOLTYPE.
+     * @return number of symbols resubscribed
+     */
+    uint32_t updateStreams();
+    /**
+     * @brief Called by the broker commands that read prints. Adds MD_PRINTS to a trimmed subscription from now on.
+     */
+    void requirePrints(Symbol &symbol);
+    StreamStatsInfo streamStats() const;
+
+    /**
+     * @brief Run the staleness watchdog. Symbols without market data for longer than their expected
+     * activity while the market is open are flagged stale and resubscribed. Called from the Zorro thread.
+     */
+    void checkStale();
+
+    /**
+     * @brief Return completed orders that Zorro has not used for RithmicOrderRetention minutes to
+     * the order pool. Checks a batch of slots per call, called from the Zorro thread.
+     * A retired order is retrieved again by BrokerTrade if needed.
+     */
+    void retireOrders();
+
+    /**
+     * @brief Report the errors queued by other threads through BrokerError. Zorro thread only.
+     */
+    void reportErrors();
+
+    /**
+     * @brief Read the top of book and last trade of several symbols as of one instant.
+     * Collects all legs, then checks that no leg changed while collecting (double collect).
+     * Updates to other symbols don't cause a retry.
+     * @param retries number of collects that had to be repeated
+     * @return false if the legs kept changing for MAX_CUT_RETRIES collects
+     */
+    bool readCut(Symbol **symbols, uint32_t n, MDTop *tops, Trade *trades, uint32_t &retries) const;
+    static constexpr uint32_t MAX_CUT_LEGS = 16;
+    static constexpr uint32_t MAX_CUT_RETRIES = 64;
+    uint64_t mdSequence() const noexcept { return md_seq_.load(std::memory_order_relaxed); }
+    auto& notifier() noexcept { return notifier_; }
+    auto& waiter() noexcept { return waiter_; }
+    const auto& ingressStats() const noexcept { return ingress_stats_; }
+    Symbol* getSymbol(uint32_t handle) noexcept { return handle < n_symbols_.load(std::memory_order_acquire) ? &symbols_[handle] : nullptr; }
+
+    /**
+     * @brief Copy the order book of an asset into a Zorro T2 list
+     * @return number of T2 entries filled, 0 if the asset has no market depth subscription or no consistent copy was read
+     */
+    int getBook(const char* asset, T2 *quotes, int max_quotes);
+
+    /**
+     * @brief Copy the last prints of an asset, or the prints since a sequence number, oldest first
+     * @return number of TradeTick filled
+     */
+    uint32_t getTrades(const char* asset, TradeQuery &query);
+
+    /**
+     * @brief Serve bars of a subscribed asset from the live bar builder, newest first.
+     * Starts a builder for the bar period if there is none yet.
+     * @param covered_from [out] bars ending after this time (seconds) are served from memory,
+     *  older bars have to be requested from the history server
+     * @return number of bars copied
+     */
+    int liveBars(const char* asset, int64_t start, int64_t end, int n_tick_minutes, int n_ticks, T6 *ticks, int64_t &covered_from);
 
     const std::vector<T6>& replayBars(char* asset, int64_t start, int64_t end, int n_tick_minutes, int n_ticks);
 
@@ -144,13 +298,18 @@ public:
      * @param duration The duration of the order. Default is Day
      * @param trigger_price The trigger price of the stop order. Default is NAN. If not NAN, the order will be a stop order.
      * @param is_short If true, the order will be a short order. Default is false.
-     * @return std::pair<std::shared_ptr<Order>, bool>. First: the order object, nullptr if the order was not sent or an error occurred. Second: is time out
+     * With SET_ASYNC_ORDERS, DAY and GTC orders return as soon as the order is sent, with a provisional Order::trade_id_.
+     * @return std::pair<Order*, bool>. First: the order object, nullptr if the order was not sent or an error occurred. Second: is time out
      */
-    std::pair<std::shared_ptr<Order>, bool> sendOrder(const char* asset, Side side, int quantity, double price = NAN, const tsNCharcb &duration = RApi::sORDER_DURATION_DAY, double trigger_price = NAN, bool is_short = false);
+    std::pair<Order*, bool> sendOrder(const char* asset, Side side, int quantity, double price = NAN, const tsNCharcb &duration = RApi::sORDER_DURATION_DAY, double trigger_price = NAN, bool is_short = false);
 
-    std::shared_ptr<Order> getOrder(uint32_t order_id) const;
+    Order* getOrder(uint32_t order_id) const;
 
-    std::shared_ptr<Order> retrieveOrder(uint32_t order_id);
+    /**
+     * @brief Look up an order by the trade id Zorro knows, replaying it from the server if it is not in memory.
+     * A provisional id is resolved through its recorded order number.
+     */
+    Order* retrieveOrder(uint32_t order_id);
 
     bool cancelOrder(uint32_t order_id);
 
@@ -170,6 +329,9 @@ public:
     int BestBidAskQuote(RApi::BidInfo *pBid, RApi::AskInfo *pAsk, void *pContext, int *aiCode) override;
     int BestBidQuote(RApi::BidInfo *pInfo, void *pContext, int *aiCode) override;
     int MarketMode(RApi::MarketModeInfo *pInfo, void *pContext, int *aiCode) override;
+    int AskQuote(RApi::AskInfo *pInfo, void *pContext, int *aiCode) override;
+    int BidQuote(RApi::BidInfo *pInfo, void *pContext, int *aiCode) override;
+    int LimitOrderBook(RApi::LimitOrderBookInfo *pInfo, void *pContext, int *aiCode) override;
 
     // Order callbacks
     int OpenOrderReplay(RApi::OrderReplayInfo *pInfo, void *pContext, int *aiCode) override;
@@ -198,21 +360,95 @@ public:
     // Trade callbacks
     int TradePrint(RApi::TradeInfo *pInfo, void *pContext, int *aiCode) override;
 
+    // Session statistics callbacks
+    int OpenPrice(RApi::OpenPriceInfo *pInfo, void *pContext, int *aiCode) override;
+    int HighPrice(RApi::HighPriceInfo *pInfo, void *pContext, int *aiCode) override;
+    int LowPrice(RApi::LowPriceInfo *pInfo, void *pContext, int *aiCode) override;
+    int ClosePrice(RApi::ClosePriceInfo *pInfo, void *pContext, int *aiCode) override;
+    int SettlementPrice(RApi::SettlementPriceInfo *pInfo, void *pContext, int *aiCode) override;
+    int OpenInterest(RApi::OpenInterestInfo *pInfo, void *pContext, int *aiCode) override;
+
 private:
     bool checkAgreements(std::string &err);
     RequestStatus waitForRequest(uint32_t timeout_ms = 0);
     void setMDReady(Symbol &symbol, MDReady falg);
+    void requestRefData(Symbol &symbol);
+    void refDataReceived(Symbol &symbol, RefPending pending, bool ok);
+    void queueRefData(RefDataReply &&reply);
+    template<typename infoT>
+    void bookEvent(const Symbol &symbol, Side side, const infoT *info);
+
+    // subscription management, see client_subscription.cpp
+    bool subscribeMD(Symbol &symbol);
+    void unsubscribeMD(Symbol &symbol);
+    bool evictLRU();
+    int mdFlags(const Symbol &symbol) const;
+    void resubscribeMD(Symbol &symbol);
+    uint64_t staleThreshold(const Symbol &symbol) const;
+    void watch(Symbol &symbol, uint64_t deadline);
+
+    // ingress, see client_ingress.cpp
+    void startIngress();
+    void stopIngress();
+    void ingressLoop();
+    template<typename QueueT, typename EventT>
+    bool pushIngress(const std::unique_ptr<QueueT> &queue, const EventT &event);
+    void waitIngressDrained();
+    void queueError(std::string &&msg);
+    void dispatch(MDEvent &event);
+    void dispatch(const PnlEvent &event);
+    void dispatch(const CancelEvent &event);
+
+    // apply a market data or pnl update to the symbol state, single writer
+    void applyMD(const MDEvent &event);
+    void applyTop(Symbol &symbol, const MDEvent &event);
+    void applyTrade(Symbol &symbol, const MDEvent &event);
+    void updateSession(Symbol &symbol, const Trade &trade);
+    void applyDailyStat(Symbol &symbol, const MDEvent &event);
+    template<typename infoT>
+    void dailyPrice(const infoT *info, void *context, uint8_t field);
+    void applyMarketMode(Symbol &symbol, const MDEvent &event);
+    void applyBook(Symbol &symbol, const MDEvent &event);
+    void recordPublish(Symbol &symbol, const MDEvent &event);
+    void applyPnl(const PnlEvent &event);
+    void applyCancel(const CancelEvent &event);
+
+    /**
+     * @brief Find a published symbol by name through symbol_index_, the name map belongs to the Zorro thread.
+     * Used by RApi callbacks that carry no subscription context and by order entry, which may run
+     * on any thread.
+     */
+    Symbol* findSymbol(std::string_view asset) noexcept;
+
+    /**
+     * @brief Resolve the symbol of a callback. Uses the subscription context when it is available,
+     * otherwise falls back to findSymbol() with the name formatted on the stack.
+     */
+    template<typename infoT>
+    Symbol* resolveSymbol(const infoT *info, void *context)
+    {
+        auto *sym = static_cast<Symbol*>(context);
+        if (sym >= symbols_.data() && sym < symbols_.data() + symbols_.size())
+        {
+            return sym;
+        }
+        char buf[64];
+        return findSymbol(symbol(info, buf));
+    }
     bool listTradeRoutes();
     bool subscribeOrder();
     bool subscribePnl();
-    void handlePnlInfo(const RApi::PnlInfo &pnl_info);
-    std::pair<std::shared_ptr<Order>, bool> sendLimitOrder(Symbol *symbol, Side side, int quantity, double price, const tsNCharcb &duration, const std::string &trade_route, bool is_short = false);
-    std::pair<std::shared_ptr<Order>, bool> sendMarketOrder(Symbol *symbol, Side side, int quantity, const std::string &trade_route, bool is_short = false);
-    std::pair<std::shared_ptr<Order>, bool> sendStopLimitOrder(Symbol *symbol, Side side, int quantity, double price, double trigger_price, const tsNCharcb &duration, const std::string &trade_route, bool is_short = false);
-    std::pair<std::shared_ptr<Order>, bool> sendStopMarketOrder(Symbol *symbol, Side side, int quantity, double trigger_price, const std::string &trade_route, bool is_short = false);
+    bool toPnlEvent(const RApi::PnlInfo &pnl_info, PnlEvent &event);
+    std::pair<Order*, bool> sendLimitOrder(Symbol *symbol, Side side, int quantity, double price, const tsNCharcb &duration, const std::string &trade_route, bool is_short = false);
+    std::pair<Order*, bool> sendMarketOrder(Symbol *symbol, Side side, int quantity, const std::string &trade_route, bool is_short = false);
+    std::pair<Order*, bool> sendStopLimitOrder(Symbol *symbol, Side side, int quantity, double price, double trigger_price, const tsNCharcb &duration, const std::string &trade_route, bool is_short = false);
+    std::pair<Order*, bool> sendStopMarketOrder(Symbol *symbol, Side side, int quantity, double trigger_price, const std::string &trade_route, bool is_short = false);
 
     template<typename ParamsT>
-    std::pair<std::shared_ptr<Order>, bool> doSendOrder(ParamsT &params, Side side, double price, int qty);
+    std::pair<Order*, bool> doSendOrder(ParamsT &params, Side side, double price, int qty);
+
+    void mapOrder(uint32_t trade_id, uint32_t handle);
+    Order* replayOrder(uint32_t order_id, uint32_t trade_id);
 };
 
 }
\ No newline at end of file
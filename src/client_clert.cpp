@@ -68,6 +68,13 @@ int RithmicClient::Alert(RApi::AlertInfo *pInfo, void *pContext, int *aiCode)
                 new_status.set(LoginStatus::FailureOccured);
             }
             while (!login_status_.compare_exchange_weak(status, new_status, std::memory_order_release, std::memory_order_relaxed));
+
+            // prints are lost while the market data connection is down
+            auto n = n_symbols_.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                symbols_[i].interruptBars();
+            }
         }
     }
 
@@ -149,6 +156,7 @@ int RithmicClient::Alert(RApi::AlertInfo *pInfo, void *pContext, int *aiCode)
         }
     }
 
+    waiter_.signal();
     *aiCode = API_OK;
     return (OK);
 }
\ No newline at end of file
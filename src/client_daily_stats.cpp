@@ -0,0 +1,125 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "stdafx.h"
+#include "client.h"
+#include "utils.h"
+
+using namespace zorro;
+using namespace RApi;
+
+template<typename infoT>
+void RithmicClient::dailyPrice(const infoT *info, void *context, uint8_t field)
+{
+    auto *sym = resolveSymbol(info, context);
+    if (sym)
+    {
+        MDEvent event{MDEventType::DailyStat};
+        event.handle_ = sym->handle_;
+        event.flags_ = field;
+        event.price_[0] = info->bPriceFlag ? info->dPrice : NAN;
+        dispatch(event);
+    }
+}
+
+int RithmicClient::OpenPrice(RApi::OpenPriceInfo *pInfo, void *pContext, int *aiCode)
+{
+    SPDLOG_DEBUG("{} OpenPrice {}", to_string_view(pInfo->sTicker), pInfo->bPriceFlag ? pInfo->dPrice : NAN);
+    dailyPrice(pInfo, pContext, mf_DailyOpen);
+    *aiCode = API_OK;
+    return (OK);
+}
+
+int RithmicClient::HighPrice(RApi::HighPriceInfo *pInfo, void *pContext, int *aiCode)
+{
+    SPDLOG_TRACE("{} HighPrice {}", to_string_view(pInfo->sTicker), pInfo->bPriceFlag ? pInfo->dPrice : NAN);
+    dailyPrice(pInfo, pContext, mf_DailyHigh);
+    *aiCode = API_OK;
+    return (OK);
+}
+
+int RithmicClient::LowPrice(RApi::LowPriceInfo *pInfo, void *pContext, int *aiCode)
+{
+    SPDLOG_TRACE("{} LowPrice {}", to_string_view(pInfo->sTicker), pInfo->bPriceFlag ? pInfo->dPrice : NAN);
+    dailyPrice(pInfo, pContext, mf_DailyLow);
+    *aiCode = API_OK;
+    return (OK);
+}
+
+int RithmicClient::ClosePrice(RApi::ClosePriceInfo *pInfo, void *pContext, int *aiCode)
+{
+    SPDLOG_DEBUG("{} ClosePrice {}", to_string_view(pInfo->sTicker), pInfo->bPriceFlag ? pInfo->dPrice : NAN);
+    dailyPrice(pInfo, pContext, mf_DailyClose);
+    *aiCode = API_OK;
+    return (OK);
+}
+
+int RithmicClient::SettlementPrice(RApi::SettlementPriceInfo *pInfo, void *pContext, int *aiCode)
+{
+    SPDLOG_DEBUG("{} SettlementPrice {}", to_string_view(pInfo->sTicker), pInfo->bPriceFlag ? pInfo->dPrice : NAN);
+    dailyPrice(pInfo, pContext, mf_DailySettlement);
+    *aiCode = API_OK;
+    return (OK);
+}
+
+int RithmicClient::OpenInterest(RApi::OpenInterestInfo *pInfo, void *pContext, int *aiCode)
+{
+    SPDLOG_DEBUG("{} OpenInterest {}", to_string_view(pInfo->sTicker), pInfo->bQuantityFlag ? pInfo->llQuantity : -1);
+    auto *sym = resolveSymbol(pInfo, pContext);
+    if (sym)
+    {
+        MDEvent event{MDEventType::DailyStat};
+        event.handle_ = sym->handle_;
+        event.flags_ = mf_DailyOpenInterest;
+        event.qty_[0] = pInfo->bQuantityFlag ? pInfo->llQuantity : -1;
+        dispatch(event);
+    }
+    *aiCode = API_OK;
+    return (OK);
+}
+
+void RithmicClient::applyDailyStat(Symbol &symbol, const MDEvent &event)
+{
+    symbol.daily_.update([&event](DailyStats &stats) {
+        switch (event.flags_)
+        {
+        case mf_DailyOpen:
+            stats.open_ = event.price_[0];
+            break;
+        case mf_DailyHigh:
+            stats.high_ = event.price_[0];
+            break;
+        case mf_DailyLow:
+            stats.low_ = event.price_[0];
+            break;
+        case mf_DailyClose:
+            stats.close_ = event.price_[0];
+            break;
+        case mf_DailySettlement:
+            stats.settlement_ = event.price_[0];
+            break;
+        case mf_DailyOpenInterest:
+            stats.open_interest_ = event.qty_[0];
+            break;
+        }
+        stats.time_ = event.recv_time_;
+    });
+}
@@ -31,6 +31,38 @@ namespace {
     auto &global = Global::get();
 }
 
+int RithmicClient::liveBars(const char* asset, int64_t start, int64_t end, int n_tick_minutes, int n_ticks, T6 *ticks, int64_t &covered_from)
+{
+    covered_from = INT64_MAX;
+    auto *symbol = getSymbol(asset);
+    if (!symbol || n_tick_minutes <= 0 || n_tick_minutes >= 1440)
+    {
+        // tick and daily data always come from the history server
+        return 0;
+    }
+
+    auto n_builders = symbol->n_bar_builders_.load(std::memory_order_acquire);
+    for (auto i = 0u; i < n_builders; ++i)
+    {
+        auto &builder = *symbol->bar_builders_[i];
+        if (builder.minutes() == (uint32_t)n_tick_minutes)
+        {
+            covered_from = builder.coveredFrom();
+            return builder.copy(start, end, get_timestamp() / 1000, n_ticks, ticks);
+        }
+    }
+
+    if (n_builders < Symbol::MAX_BAR_BUILDERS)
+    {
+        SPDLOG_INFO("Start {} {}-minute live bars", asset, n_tick_minutes);
+        symbol->bar_builders_[n_builders] = std::make_unique<BarBuilder>(n_tick_minutes);
+        symbol->n_bar_builders_.store(n_builders + 1, std::memory_order_release);
+        // live bars need the trade prints
+        updateStreams();
+    }
+    return 0;
+}
+
 const std::vector<T6>& RithmicClient::replayBars(char* asset, int64_t start, int64_t end, int n_tick_minutes, int n_ticks)
 {
     ticks_.clear();
@@ -133,6 +165,7 @@ int RithmicClient::BarReplay(RApi::BarReplayInfo *pInfo, void *pContext, int *ai
         SPDLOG_DEBUG("BarReplay err: {}", to_string_view(pInfo->sRpCode));
     }
     request_status_.store(RequestStatus::Complete, std::memory_order_release);
+    waiter_.signal();
     *aiCode = API_OK;
     return (OK);
 }
@@ -0,0 +1,270 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "stdafx.h"
+#include "client.h"
+#include "config.h"
+#include "utils.h"
+#include "global.h"
+
+using namespace zorro;
+using namespace RApi;
+
+void RithmicClient::startIngress()
+{
+    if (!use_ingress_ || ingress_running_.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    md_queue_ = std::make_unique<MDQueue>();
+    pnl_queue_ = std::make_unique<PnlQueue>();
+    cancel_queue_ = std::make_unique<CancelQueue>();
+    ingress_event_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    ingress_draining_.store(true, std::memory_order_relaxed);
+    ingress_running_.store(true, std::memory_order_release);
+    ingress_thread_ = std::thread([this]() { ingressLoop(); });
+    SPDLOG_INFO("Ingress thread started");
+}
+
+void RithmicClient::stopIngress()
+{
+    if (!ingress_running_.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    SetEvent(ingress_event_);
+    if (ingress_thread_.joinable())
+    {
+        ingress_thread_.join();
+    }
+    CloseHandle(ingress_event_);
+    ingress_event_ = nullptr;
+}
+
+void RithmicClient::ingressLoop()
+{
+    auto spin_count = Config::get().wait_spin_count_;
+    uint32_t idle = 0;
+    auto drain = [this]() {
+        auto n = md_queue_->consume([this](const MDEvent &event) { applyMD(event); });
+        n += pnl_queue_->consume([this](const PnlEvent &event) { applyPnl(event); });
+        n += cancel_queue_->consume([this](const CancelEvent &event) { applyCancel(event); });
+        return n;
+    };
+
+    while (ingress_running_.load(std::memory_order_acquire))
+    {
+        if (drain())
+        {
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < spin_count)
+        {
+            YieldProcessor();
+            continue;
+        }
+
+        // announce the sleep before the last check so a producer either sees the flag or its event is drained here
+        ingress_sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (md_queue_->empty() && pnl_queue_->empty() && cancel_queue_->empty())
+        {
+            WaitForSingleObject(ingress_event_, 1);
+        }
+        ingress_sleeping_.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+    // a push that saw the thread running lands in a queue, drain once it is done
+    while (ingress_pushing_.load(std::memory_order_seq_cst))
+    {
+        YieldProcessor();
+    }
+    drain();
+    // callbacks apply their events themselves from here on
+    ingress_draining_.store(false, std::memory_order_release);
+}
+
+template<typename QueueT, typename EventT>
+bool RithmicClient::pushIngress(const std::unique_ptr<QueueT> &queue, const EventT &event)
+{
+    // either the ingress thread sees this push in progress or this push sees the thread stopped
+    ingress_pushing_.fetch_add(1, std::memory_order_seq_cst);
+    bool queued = ingress_running_.load(std::memory_order_seq_cst);
+
+    // never drop market data, wait for the ingress thread to make room
+    while (queued && !queue->tryPush(event))
+    {
+        ingress_stats_.stalls_.fetch_add(1, std::memory_order_relaxed);
+        // stopping, the caller applies the event itself
+        queued = ingress_running_.load(std::memory_order_relaxed);
+        YieldProcessor();
+    }
+
+    if (queued)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ingress_sleeping_.load(std::memory_order_relaxed))
+        {
+            SetEvent(ingress_event_);
+        }
+    }
+    ingress_pushing_.fetch_sub(1, std::memory_order_release);
+    return queued;
+}
+
+void RithmicClient::waitIngressDrained()
+{
+    // Before the first login and after stopIngress the callback applies its event inline. The ingress
+    // thread may still be applying the rest of its queues, wait for it so the symbol state keeps one writer.
+    while (ingress_draining_.load(std::memory_order_acquire))
+    {
+        YieldProcessor();
+    }
+    ingress_stats_.inline_events_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RithmicClient::dispatch(MDEvent &event)
+{
+    event.recv_time_ = get_timestamp_ns();
+    ingress_stats_.md_events_.fetch_add(1, std::memory_order_relaxed);
+    if (use_ingress_)
+    {
+        if (pushIngress(md_queue_, event))
+        {
+            return;
+        }
+        waitIngressDrained();
+    }
+    applyMD(event);
+}
+
+void RithmicClient::dispatch(const PnlEvent &event)
+{
+    ingress_stats_.pnl_events_.fetch_add(1, std::memory_order_relaxed);
+    if (use_ingress_)
+    {
+        if (pushIngress(pnl_queue_, event))
+        {
+            return;
+        }
+        waitIngressDrained();
+    }
+    applyPnl(event);
+}
+
+void RithmicClient::dispatch(const CancelEvent &event)
+{
+    ingress_stats_.cancels_.fetch_add(1, std::memory_order_relaxed);
+    if (use_ingress_ && pushIngress(cancel_queue_, event))
+    {
+        return;
+    }
+    applyCancel(event);
+}
+
+void RithmicClient::queueError(std::string &&msg)
+{
+    std::lock_guard lock(errors_mutex_);
+    errors_.push_back(std::move(msg));
+}
+
+void RithmicClient::reportErrors()
+{
+    std::vector<std::string> errors;
+    {
+        std::lock_guard lock(errors_mutex_);
+        if (errors_.empty())
+        {
+            return;
+        }
+        errors.swap(errors_);
+    }
+    for (auto &msg : errors)
+    {
+        BrokerError(msg.c_str());
+    }
+}
+
+void RithmicClient::applyMD(const MDEvent &event)
+{
+    auto &symbol = symbols_[event.handle_];
+    symbol.updates_.store(symbol.updates_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    md_seq_.store(md_seq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    symbol.last_update_ms_.store(event.recv_time_ / 1000000, std::memory_order_relaxed);
+    if (symbol.stale_.load(std::memory_order_relaxed))
+    {
+        symbol.stale_.store(false, std::memory_order_release);
+    }
+    switch (event.type_)
+    {
+    case MDEventType::Top:
+        applyTop(symbol, event);
+        break;
+    case MDEventType::Trade:
+        applyTrade(symbol, event);
+        break;
+    case MDEventType::MarketMode:
+        applyMarketMode(symbol, event);
+        break;
+    case MDEventType::Book:
+        applyBook(symbol, event);
+        break;
+    case MDEventType::DailyStat:
+        applyDailyStat(symbol, event);
+        break;
+    }
+}
+
+void RithmicClient::recordPublish(Symbol &symbol, const MDEvent &event)
+{
+    if (!symbol.latency_)
+    {
+        return;
+    }
+
+    auto &latency = *symbol.latency_;
+    auto now = get_timestamp_ns();
+    latency[LatencyStage::Publish].record(now - event.recv_time_);
+    // single writer, BrokerAsset only resets it to 0
+    if (!latency.unread_since_.load(std::memory_order_relaxed))
+    {
+        latency.unread_since_.store(now, std::memory_order_release);
+    }
+}
+
+void RithmicClient::applyCancel(const CancelEvent &event)
+{
+    char buf[16];
+    auto result = std::format_to_n(buf, sizeof(buf), "{}", event.order_num_);
+    tsNCharcb order_num{buf, (int)result.size};
+    int iCode;
+    if (!engine_->cancelOrder(&account_info_, &order_num, (tsNCharcb*)&sORDER_ENTRY_TYPE_AUTO, nullptr, nullptr, nullptr, &iCode))
+    {
+        auto msg = std::format("Pending cancel, failed to cancel {}. err: {}", to_string_view(order_num), iCode);
+        SPDLOG_ERROR(msg);
+        // may run on the ingress or R|API thread, Zorro callbacks are only made from the Zorro thread
+        queueError(std::move(msg));
+    }
+}
@@ -34,76 +34,178 @@ namespace {
 RithmicClient::RequestStatus RithmicClient::waitForRequest(uint32_t timeout_ms)
 {
     RequestStatus status;
-    if (timeout_ms > 0)
+    switch (waiter_.wait(WaitSite::Request, [&]() { return (status = request_status_.load(std::memory_order_acquire)) != RequestStatus::AwaitingResults; }, timeout_ms))
     {
-        auto start = get_timestamp();
-        while ((status = request_status_.load(std::memory_order_relaxed)) == RequestStatus::AwaitingResults)
-        {
-            if (!BrokerProgress(1))
-            {
-                status = RequestStatus::Failed;
-                break;
-            }
-            if ((get_timestamp() - start) > timeout_ms)
-            {
-                status = RequestStatus::Timeout;
-                break;
-            }
-        }
+    case WaitResult::Aborted:
+        status = RequestStatus::Failed;
+        break;
+    case WaitResult::Timeout:
+        status = RequestStatus::Timeout;
+        break;
+    default:
+        break;
     }
-    else
+    request_status_.store(RequestStatus::NoRequest, std::memory_order_relaxed);
+    return status;
+}
+
+bool RithmicClient::waitPriceIncrement(Symbol &symbol)
+{
+    if (!(symbol.ref_pending_.load(std::memory_order_relaxed) & rp_PriceIncr))
     {
-        while((status = request_status_.load(std::memory_order_relaxed)) == RequestStatus::AwaitingResults)
+        tsNCharcb exchange{symbol.spec_.exchange_.data(), (int)symbol.spec_.exchange_.length()};
+        tsNCharcb ticker{symbol.spec_.ticker_.data(), (int)symbol.spec_.ticker_.length()};
+        int icode;
+        if (!engine_->getPriceIncrInfo(&exchange, &ticker, &icode))
         {
-            if (!BrokerProgress(1))
-            {
-                status = RequestStatus::Failed;
-                break;
-            }
+            BrokerError(std::format("REngine::getPriceIncInfo() err: {}", icode).c_str());
+            return false;
         }
+        symbol.ref_pending_.fetch_or(rp_PriceIncr, std::memory_order_relaxed);
     }
-    request_status_.store(RequestStatus::NoRequest, std::memory_order_relaxed);
-    return status;
+
+    // the reply is applied by this thread, drain the queue while waiting for it
+    auto result = waiter_.wait(WaitSite::Request, [&]() {
+        applyRefData();
+        return !(symbol.ref_pending_.load(std::memory_order_relaxed) & rp_PriceIncr);
+    }, 10000);
+    if (result != WaitResult::Done)
+    {
+        // treated like a failed reply, a late one is ignored
+        refDataReceived(symbol, rp_PriceIncr, false);
+    }
+    return symbol.spec_.price_increment_ > 0;
 }
 
-bool RithmicClient::getRefData(tsNCharcb &exchange, tsNCharcb &symbol)
+void RithmicClient::requestRefData(Symbol &symbol)
 {
+    // Both requests are sent at once right before the market data subscription, the replies are
+    // applied by applyRefData() and the symbol becomes RefData ready when the last of them is answered.
+    tsNCharcb exchange{symbol.spec_.exchange_.data(), (int)symbol.spec_.exchange_.length()};
+    tsNCharcb ticker{symbol.spec_.ticker_.data(), (int)symbol.spec_.ticker_.length()};
+    uint8_t pending = rp_RefData | (symbol.spec_.price_increment_ > 0 ? 0 : rp_PriceIncr);
+    symbol.ref_failed_ = 0;
+    symbol.ref_pending_.store(pending, std::memory_order_release);
+
     int icode;
-    request_status_.store(RequestStatus::AwaitingResults, std::memory_order_relaxed);
-    if (!engine_->getRefData(&exchange, &symbol, &icode))
+    if (!engine_->getRefData(&exchange, &ticker, &icode))
     {
-        BrokerError(std::format("REngine::getRefData() err: {}", icode).c_str());
-        return false;
+        SPDLOG_ERROR("REngine::getRefData() {} err: {}", symbol.spec_.symbol_, icode);
+        refDataReceived(symbol, rp_RefData, false);
+    }
+    if ((pending & rp_PriceIncr) && !engine_->getPriceIncrInfo(&exchange, &ticker, &icode))
+    {
+        SPDLOG_ERROR("REngine::getPriceIncrInfo() {} err: {}", symbol.spec_.symbol_, icode);
+        refDataReceived(symbol, rp_PriceIncr, false);
+    }
+}
+
+void RithmicClient::refDataReceived(Symbol &symbol, RefPending pending, bool ok)
+{
+    if (!ok)
+    {
+        symbol.ref_failed_ |= pending;
+    }
+    auto prev = symbol.ref_pending_.fetch_and((uint8_t)~pending, std::memory_order_acq_rel);
+    if ((prev & pending) && !(prev & ~pending))
+    {
+        // answered either way, but only a complete answer replaces the asset list values and is cached
+        auto &spec = symbol.spec_;
+        spec.ref_valid_ = !symbol.ref_failed_ && spec.price_increment_ > 0;
+        if (spec.ref_valid_)
+        {
+            spec.ref_time_ = get_timestamp() / 1000;
+        }
+        else
+        {
+            SPDLOG_WARN("{} reference data incomplete, failed requests {}", spec.symbol_, (int)symbol.ref_failed_);
+        }
+        setMDReady(symbol, MDReady::RefData);
     }
+}
 
-    auto status = waitForRequest();
-    return status == RequestStatus::Complete;
+void RithmicClient::queueRefData(RefDataReply &&reply)
+{
+    {
+        std::lock_guard lock(ref_replies_mutex_);
+        ref_replies_.push_back(std::move(reply));
+    }
+    waiter_.signal();
 }
 
-bool RithmicClient::getPriceIncInfo(tsNCharcb &exchange, tsNCharcb &symbol)
+void RithmicClient::applyRefData()
 {
-    int icode;
-    request_status_.store(RequestStatus::AwaitingResults, std::memory_order_relaxed);
-    if (!engine_->getPriceIncrInfo(&exchange, &symbol, &icode))
+    std::vector<RefDataReply> replies;
     {
-        BrokerError(std::format("REngine::getPriceIncInfo() err: {}", icode).c_str());
-        return false;
+        std::lock_guard lock(ref_replies_mutex_);
+        if (ref_replies_.empty())
+        {
+            return;
+        }
+        replies.swap(ref_replies_);
     }
 
-    auto status = waitForRequest();
-    return status == RequestStatus::Complete;
+    for (auto &reply : replies)
+    {
+        auto *sym = getSymbol(reply.symbol_);
+        if (!sym || !(sym->ref_pending_.load(std::memory_order_relaxed) & reply.kind_))
+        {
+            SPDLOG_DEBUG("Unexpected ref data reply {}", reply.symbol_);
+            continue;
+        }
+
+        auto &spec = sym->spec_;
+        if (reply.ok_ && reply.kind_ == rp_RefData)
+        {
+            spec.product_ = std::move(reply.product_);
+            spec.type_ = std::move(reply.type_);
+            spec.tradable_ = reply.tradable_;
+            if (reply.has_size_multiplier_)
+            {
+                spec.size_muliplier = reply.size_multiplier_;
+            }
+            if (reply.has_min_size_increment_)
+            {
+                spec.min_size_increment_ = reply.min_size_increment_;
+            }
+        }
+        else if (reply.ok_ && reply.kind_ == rp_PriceIncr && reply.price_increment_ > 0)
+        {
+            spec.price_increment_ = reply.price_increment_;
+        }
+        refDataReceived(*sym, reply.kind_, reply.ok_);
+    }
+}
+
+void RithmicClient::saveRefData()
+{
+    applyRefData();
+    for (uint32_t i = 0; i < n_symbols_.load(std::memory_order_acquire); ++i)
+    {
+        if (!symbols_[i].ref_pending_.load(std::memory_order_acquire))
+        {
+            ref_data_cache_.update(symbols_[i].spec_);
+        }
+    }
+    ref_data_cache_.save();
 }
 
-Symbol* RithmicClient::getSymbol(const char* asset)
+Symbol* RithmicClient::getSymbol(std::string_view asset)
 {
-    auto iter = symbols_.find(asset);
-    if (iter != symbols_.end())
+    auto iter = symbol_handles_.find(asset);
+    if (iter != symbol_handles_.end())
     {
-        return &(iter->second);
+        return &symbols_[iter->second];
     }
     return nullptr;
 }
 
+Symbol* RithmicClient::findSymbol(std::string_view asset) noexcept
+{
+    auto handle = symbol_index_.find(asset, [this](uint32_t h) -> const std::string& { return symbols_[h].spec_.symbol_; });
+    return handle != symbol_index_.INVALID ? &symbols_[handle] : nullptr;
+}
+
 bool RithmicClient::subscribe(const char* asset)
 {
     SPDLOG_INFO("subscribe {}", asset);
@@ -120,48 +222,87 @@ bool RithmicClient::subscribe(const char* asset)
     auto str_ticker = _asset.substr(0, pos);
     auto str_exchange = _asset.substr(pos + 1);
 
-    asset_position_.emplace(asset, Position{});
+    auto handle = n_symbols_.load(std::memory_order_relaxed);
+    if (handle >= MAX_SYMBOL_NUM)
+    {
+        BrokerError(std::format("Failed to subscribe {}. Max {} symbols reached", asset, MAX_SYMBOL_NUM).c_str());
+        return false;
+    }
 
-    auto &sym = symbols_[asset];
+    // The slot is only published (n_symbols_) after the subscription succeeded,
+    // a failed subscription leaves it to be reused by the next one.
+    auto &sym = symbols_[handle];
+    sym = Symbol{};
+    sym.handle_ = handle;
     sym.spec_.symbol_ = asset;
     sym.spec_.ticker_ = str_ticker;
     sym.spec_.exchange_ = str_exchange;
+    sym.trades_ = std::make_unique<TradeHistory>();
+    sym.latency_ = std::make_unique<LatencyStats>();
 
-    tsNCharcb exchange{(char*)str_exchange.data(), (int)str_exchange.length()};
-    tsNCharcb ticker{(char*)str_ticker.data(), (int)str_ticker.length()};
-    // if (!getRefData(exch, ticker))
-    // {
-    //     return false;
-    // }
+    bool cached = ref_data_cache_.apply(sym.spec_, get_timestamp() / 1000);
+
+    symbol_handles_.emplace(asset, handle);
+    if (!cached)
+    {
+        requestRefData(sym);
+    }
 
-    int i_code;
-    if (!engine_->subscribe(&exchange, &ticker, MD_PRINTS | MD_BEST | MD_MARKET_MODE, &i_code))
+    // MD_PRINTS and MD_BEST are added by subscribeMD, see mdFlags()
+    sym.subscribe_flags_ = 0;
+    if (global.market_depth_)
+    {
+        // the book is indexed by ticks, the price increment is required before the first depth update
+        if (sym.spec_.price_increment_ > 0 || waitPriceIncrement(sym))
+        {
+            sym.book_ = std::make_unique<OrderBook>(sym.spec_.price_increment_);
+            sym.subscribe_flags_ |= MD_QUOTES;
+        }
+        else
+        {
+            BrokerError(std::format("{} price increment unavailable, market depth not subscribed", asset).c_str());
+        }
+    }
+    if (global.daily_stats_)
     {
-        BrokerError(std::format("REngine::subscribe() err: {}", i_code).c_str());
-        symbols_.erase(asset);
+        sym.subscribe_flags_ |= MD_OPEN | MD_HIGH_LOW | MD_CLOSE | MD_SETTLEMENT | MD_OPEN_INTEREST;
+    }
+
+    if (!subscribeMD(sym))
+    {
+        symbol_handles_.erase(sym.spec_.symbol_);
         return false;
     }
+    symbol_index_.insert(sym.spec_.symbol_, handle);
+    n_symbols_.store(handle + 1, std::memory_order_release);
+
+    if (cached)
+    {
+        setMDReady(sym, MDReady::RefData);
+    }
     return true;
 }
 
-
 int RithmicClient::RefData(RApi::RefDataInfo *pInfo, void *pContext, int *aiCode)
 {
-    std::string sym = symbol(pInfo);
-    SPDLOG_DEBUG("RefData {}, bMinSizeIncrement={}, MinSizeIncrement={}, bSizeMultiplier={}, sizeMultiplier={}", sym, pInfo->bMinSizeIncrement, pInfo->llMinSizeIncrement, pInfo->bSizeMultiplier, pInfo->dSizeMultiplier);
-    auto iter = symbols_.find(sym);
-    if (iter != symbols_.end())
+    SPDLOG_DEBUG("RefData {}.{}, bMinSizeIncrement={}, MinSizeIncrement={}, bSizeMultiplier={}, sizeMultiplier={}", to_string_view(pInfo->sTicker), to_string_view(pInfo->sExchange),
+        pInfo->bMinSizeIncrement, pInfo->llMinSizeIncrement, pInfo->bSizeMultiplier, pInfo->dSizeMultiplier);
+    RefDataReply reply;
+    reply.kind_ = rp_RefData;
+    reply.ok_ = pInfo->iRpCode == API_OK;
+    reply.symbol_ = symbol(pInfo);
+    if (!reply.ok_)
     {
-        auto &symbol = iter->second;
-        symbol.spec_.product_ = std::string(pInfo->sProductCode.pData, pInfo->sProductCode.iDataLen);
-        symbol.spec_.tradable_ = pInfo->sIsTradable.iDataLen == 4;
-
-        request_status_.store(RequestStatus::Complete, std::memory_order_release);
-    }
-    else
-    {
-        request_status_.store(RequestStatus::Failed, std::memory_order_release);
+        SPDLOG_INFO("RefData {} err: {}", reply.symbol_, to_string_view(pInfo->sRpCode));
     }
+    reply.product_ = to_string(pInfo->sProductCode);
+    reply.type_ = to_string(pInfo->sInstrumentType);
+    reply.tradable_ = pInfo->sIsTradable.iDataLen == 4;
+    reply.has_size_multiplier_ = pInfo->bSizeMultiplier;
+    reply.size_multiplier_ = pInfo->dSizeMultiplier;
+    reply.has_min_size_increment_ = pInfo->bMinSizeIncrement;
+    reply.min_size_increment_ = pInfo->llMinSizeIncrement;
+    queueRefData(std::move(reply));
 
     *aiCode = API_OK;
     return (OK);
@@ -169,30 +310,19 @@ int RithmicClient::RefData(RApi::RefDataInfo *pInfo, void *pContext, int *aiCode
 
 int RithmicClient::PriceIncrUpdate(RApi::PriceIncrInfo *pInfo, void *pContext, int *aiCode)
 {
-    if (pInfo->iRpCode != API_OK)
+    RefDataReply reply;
+    reply.kind_ = rp_PriceIncr;
+    reply.ok_ = pInfo->iRpCode == API_OK;
+    reply.symbol_ = symbol(pInfo);
+    if (!reply.ok_)
     {
         SPDLOG_INFO("PriceIncrUpdate err: {}", to_string_view(pInfo->sRpCode));
-        request_status_.store(RequestStatus::Failed, std::memory_order_release);
-        *aiCode = API_OK;
-        return (OK);
     }
-
-    std::string sym = symbol(pInfo);
-    auto iter = symbols_.find(sym);
-    if (iter != symbols_.end())
+    for (auto i = 0; reply.ok_ && i < pInfo->iArrayLen; ++i)
     {
-        auto &symbol = iter->second;
-        for (auto i = 0; i < pInfo->iArrayLen; ++i)
-        {
-            auto &price_incr = pInfo->asPriceIncrArray[i];
-            symbol.spec_.price_increment_ = price_incr.dPriceIncr;
-        }
-        request_status_.store(RequestStatus::Complete, std::memory_order_release);
-    }
-    else
-    {
-        request_status_.store(RequestStatus::Failed, std::memory_order_release);
+        reply.price_increment_ = pInfo->asPriceIncrArray[i].dPriceIncr;
     }
+    queueRefData(std::move(reply));
 
     *aiCode = API_OK;
     return (OK);
@@ -213,42 +343,42 @@ void RithmicClient::setMDReady(Symbol &symbol, MDReady flag)
         new_ready.set(flag);
     } while(!symbol.ready_.compare_exchange_weak(ready, new_ready, std::memory_order_release, std::memory_order_relaxed));
     SPDLOG_INFO("{} {} ready. {}", symbol.spec_.symbol_, to_string(flag), new_ready.to_ulong());
+
+    if (flag != MDReady::RefData && symbol.isReady())
+    {
+        auto now = get_timestamp();
+        symbol.ready_time_.store(now, std::memory_order_release);
+        SPDLOG_INFO("{} ready in {} ms", symbol.spec_.symbol_, now - symbol.subscribe_time_);
+        waiter_.signal();
+    }
+}
+
+template<typename infoT>
+static void topFields(const infoT *info, MDEvent &event, uint8_t price_flag, uint8_t size_flag, int i)
+{
+    if (info->bPriceFlag)
+    {
+        event.flags_ |= price_flag;
+        event.price_[i] = info->dPrice;
+    }
+    if (info->bSizeFlag)
+    {
+        event.flags_ |= size_flag;
+        event.qty_[i] = info->llSize;
+    }
 }
 
 int RithmicClient::BestAskQuote(RApi::AskInfo *pInfo, void *pContext, int *aiCode)
 {
-    std::string sym = symbol(pInfo);
-    SPDLOG_TRACE("{} BestAsk {}@{}", sym, pInfo->bSizeFlag ? pInfo->llSize : 0, pInfo->bPriceFlag ? pInfo->dPrice : NAN);
-    auto iter = symbols_.find(sym);
-    if (iter != symbols_.end())
+    CallbackTimer timer(ingress_stats_);
+    SPDLOG_TRACE("{} BestAsk {}@{}", to_string_view(pInfo->sTicker), pInfo->bSizeFlag ? pInfo->llSize : 0, pInfo->bPriceFlag ? pInfo->dPrice : NAN);
+    auto *sym = resolveSymbol(pInfo, pContext);
+    if (sym && (pInfo->bPriceFlag || pInfo->bSizeFlag))
     {
-        if (pInfo->bPriceFlag || pInfo->bSizeFlag)
-        {
-            MDTop top = iter->second.top_.load(std::memory_order_relaxed);
-            bool was_nan = std::isnan(top.ask_price_);
-            MDTop new_top;
-            do
-            {
-                new_top = top;
-                if (pInfo->bPriceFlag)
-                {
-                    new_top.ask_price_ = pInfo->dPrice;
-                }
-                if (pInfo->bSizeFlag)
-                {
-                    new_top.ask_qty_ = pInfo->llSize;
-                }
-            }
-            while (!iter->second.top_.compare_exchange_weak(top, new_top, std::memory_order_release, std::memory_order_relaxed));
-            if (was_nan && !std::isnan(new_top.ask_price_))
-            {
-                setMDReady(iter->second, MDReady::Top);
-            }
-            if (global.handle_ && global.price_type_.load(std::memory_order_relaxed) != 2)
-            {
-                PostMessage(global.handle_, WM_APP+1, 0, 0);
-            }
-        }
+        MDEvent event{MDEventType::Top};
+        event.handle_ = sym->handle_;
+        topFields(pInfo, event, mf_AskPrice, mf_AskSize, 1);
+        dispatch(event);
     }
     *aiCode = API_OK;
     return (OK);
@@ -256,108 +386,337 @@ int RithmicClient::BestAskQuote(RApi::AskInfo *pInfo, void *pContext, int *aiCod
 
 int RithmicClient::BestBidAskQuote(RApi::BidInfo *pBid, RApi::AskInfo *pAsk, void *pContext, int *aiCode)
 {
-    std::string sym = symbol(pBid);
-    SPDLOG_TRACE("{} BestBid: {}@{} BestAsk: {}@{}", sym, pBid->bSizeFlag ? pBid->llSize : 0, pBid->bPriceFlag ? pBid->dPrice : NAN, 
+    CallbackTimer timer(ingress_stats_);
+    SPDLOG_TRACE("{} BestBid: {}@{} BestAsk: {}@{}", to_string_view(pBid->sTicker), pBid->bSizeFlag ? pBid->llSize : 0, pBid->bPriceFlag ? pBid->dPrice : NAN, 
         pAsk->bSizeFlag ? pAsk->llSize : 0, pAsk->bPriceFlag ? pAsk->dPrice : NAN);
-    auto iter = symbols_.find(sym);
-    if (iter != symbols_.end())
+    auto *sym = resolveSymbol(pBid, pContext);
+    if (sym && (pBid->bPriceFlag || pBid->bSizeFlag || pAsk->bPriceFlag || pAsk->bSizeFlag))
+    {
+        MDEvent event{MDEventType::Top};
+        event.handle_ = sym->handle_;
+        topFields(pBid, event, mf_BidPrice, mf_BidSize, 0);
+        topFields(pAsk, event, mf_AskPrice, mf_AskSize, 1);
+        dispatch(event);
+    }
+    *aiCode = API_OK;
+    return (OK);
+}
+
+int RithmicClient::BestBidQuote(RApi::BidInfo *pInfo, void *pContext, int *aiCode)
+{
+    CallbackTimer timer(ingress_stats_);
+    SPDLOG_TRACE("{} BestBid {}@{}", to_string_view(pInfo->sTicker), pInfo->bSizeFlag ? pInfo->llSize : 0, pInfo->bPriceFlag ? pInfo->dPrice : NAN);
+    auto *sym = resolveSymbol(pInfo, pContext);
+    if (sym && (pInfo->bPriceFlag || pInfo->bSizeFlag))
+    {
+        MDEvent event{MDEventType::Top};
+        event.handle_ = sym->handle_;
+        topFields(pInfo, event, mf_BidPrice, mf_BidSize, 0);
+        dispatch(event);
+    }
+    *aiCode = API_OK;
+    return (OK);
+}
+
+void RithmicClient::applyTop(Symbol &symbol, const MDEvent &event)
+{
+    MDTop new_top = symbol.top_.load();
+    if (event.flags_ & mf_BidPrice)
+    {
+        new_top.bid_price_ = event.price_[0];
+    }
+    if (event.flags_ & mf_BidSize)
+    {
+        new_top.bid_qty_ = event.qty_[0];
+    }
+    if (event.flags_ & mf_AskPrice)
+    {
+        new_top.ask_price_ = event.price_[1];
+    }
+    if (event.flags_ & mf_AskSize)
+    {
+        new_top.ask_qty_ = event.qty_[1];
+    }
+    new_top.derive();
+    new_top.update_seq_ = md_seq_.load(std::memory_order_relaxed);
+    symbol.top_.store(new_top);
+    recordPublish(symbol, event);
+    if (recorder_)
     {
-        if (pBid->bPriceFlag || pBid->bSizeFlag || pAsk->bPriceFlag || pAsk->bSizeFlag)
+        auto time = nanosec_to_date(event.recv_time_);
+        if (event.flags_ & (mf_BidPrice | mf_BidSize))
         {
-            auto top = iter->second.top_.load(std::memory_order_relaxed);
-            bool was_nan = std::isnan(top.ask_price_);
-            MDTop new_top;
-            do
-            {
-                new_top = top;
-                if (pBid->bPriceFlag)
-                {
-                    new_top.bid_price_ = pBid->dPrice;
-                }
-                if (pBid->bSizeFlag)
-                {
-                    new_top.bid_qty_ = pBid->llSize;
-                }
-                if (pAsk->bPriceFlag)
-                {
-                    new_top.ask_price_ = pAsk->dPrice;
-                }
-                if (pAsk->bSizeFlag)
-                {
-                    new_top.ask_qty_ = pAsk->llSize;
-                }
-            }
-            while (!iter->second.top_.compare_exchange_weak(top, new_top, std::memory_order_release, std::memory_order_relaxed));
-            if (was_nan && !std::isnan(new_top.ask_price_))
-            {
-                setMDReady(iter->second, MDReady::Top);
-            }
-            if (global.handle_ && global.price_type_.load(std::memory_order_relaxed) != 2)
-            {
-                PostMessage(global.handle_, WM_APP+1, 0, 0);
-            }
+            recorder_->record(symbol.handle_, TickRecorder::Type::T2, time, -(float)new_top.bid_price_, (float)new_top.bid_qty_);
+        }
+        if (event.flags_ & (mf_AskPrice | mf_AskSize))
+        {
+            recorder_->record(symbol.handle_, TickRecorder::Type::T2, time, (float)new_top.ask_price_, (float)new_top.ask_qty_);
         }
     }
+    if (!std::isnan(new_top.ask_price_) && !symbol.ready_.load(std::memory_order_relaxed).test(MDReady::Top))
+    {
+        setMDReady(symbol, MDReady::Top);
+    }
+    if (global.price_type_.load(std::memory_order_relaxed) != 2)
+    {
+        notifier_.notify(symbol.handle_, global.handle_);
+    }
+}
+
+int RithmicClient::MarketMode(RApi::MarketModeInfo *pInfo, void *pContext, int *aiCode)
+{
+    SPDLOG_INFO("MarketMode: {}.{} marketMode={} event={} reason={}", to_string_view(pInfo->sTicker), to_string_view(pInfo->sExchange), to_string_view(pInfo->sMarketMode),
+        to_string_view(pInfo->sEvent), to_string_view(pInfo->sReason));
+    auto *sym = resolveSymbol(pInfo, pContext);
+    if (sym)
+    {
+        auto status = to_string_view(pInfo->sMarketMode);
+        MDEvent event{MDEventType::MarketMode};
+        event.handle_ = sym->handle_;
+        event.flags_ = (status == "Open" || status == "Pre Open") ? mf_Open : 0;
+        dispatch(event);
+    }
     *aiCode = API_OK;
     return (OK);
 }
 
-int RithmicClient::BestBidQuote(RApi::BidInfo *pInfo, void *pContext, int *aiCode)
+void RithmicClient::applyMarketMode(Symbol &symbol, const MDEvent &event)
+{
+    symbol.can_trade_.exchange(event.flags_ & mf_Open, std::memory_order_acq_rel);
+    setMDReady(symbol, MDReady::Status);
+}
+
+uint32_t RithmicClient::subscribeAll(std::string_view assets, uint32_t timeout_ms)
 {
-    std::string sym = symbol(pInfo);
-    SPDLOG_TRACE("{} BestBid {}@{}", sym, pInfo->bSizeFlag ? pInfo->llSize : 0, pInfo->bPriceFlag ? pInfo->dPrice : NAN);
-    auto iter = symbols_.find(sym);
-    if (iter != symbols_.end())
+    // send all subscriptions first, then wait for them together
+    std::vector<Symbol*> pending;
+    size_t pos = 0;
+    while (pos < assets.size())
     {
-        if (pInfo->bPriceFlag || pInfo->bSizeFlag)
+        auto next = assets.find_first_of(",; ", pos);
+        if (next == std::string_view::npos)
         {
-            auto top = iter->second.top_.load(std::memory_order_relaxed);
-            MDTop new_top;
-            do
-            {
-                new_top = top;
-                if (pInfo->bPriceFlag)
-                {
-                    new_top.bid_price_ = pInfo->dPrice;
-                }
-                if (pInfo->bSizeFlag)
-                {
-                    new_top.bid_qty_ = pInfo->llSize;
-                }
-            }
-            while (!iter->second.top_.compare_exchange_weak(top, new_top, std::memory_order_release, std::memory_order_relaxed));
-            if (global.handle_ && global.price_type_.load(std::memory_order_relaxed) != 2)
-            {
-                PostMessage(global.handle_, WM_APP+1, 0, 0);
-            }
+            next = assets.size();
+        }
+        std::string asset(assets.substr(pos, next - pos));
+        pos = next + 1;
+        if (asset.empty())
+        {
+            continue;
+        }
+
+        auto *sym = acquireSymbol(asset.c_str(), true);
+        if (sym)
+        {
+            pending.push_back(sym);
         }
     }
+
+    auto start = get_timestamp();
+    uint32_t n_ready = 0;
+    waiter_.wait(WaitSite::Subscribe, [&]() {
+        n_ready = (uint32_t)std::count_if(pending.begin(), pending.end(), [](const Symbol *sym) { return sym->isReady(); });
+        return n_ready == pending.size();
+    }, timeout_ms);
+
+    for (auto *sym : pending)
+    {
+        if (sym->isReady())
+        {
+            SPDLOG_INFO("{} readiness latency {} ms", sym->spec_.symbol_, sym->ready_time_.load(std::memory_order_relaxed) - sym->subscribe_time_);
+        }
+        else
+        {
+            BrokerError(std::format("{} no data", sym->spec_.symbol_).c_str());
+        }
+    }
+    SPDLOG_INFO("{}/{} assets ready in {} ms", n_ready, pending.size(), get_timestamp() - start);
+    saveRefData();
+    return n_ready;
+}
+
+template<typename infoT>
+void RithmicClient::bookEvent(const Symbol &symbol, Side side, const infoT *info)
+{
+    MDEvent event{MDEventType::Book};
+    event.handle_ = symbol.handle_;
+    event.side_ = side;
+    if (info->sUpdateType == sUPDATE_TYPE_CLEAR)
+    {
+        event.flags_ = mf_BookClear;
+        dispatch(event);
+        return;
+    }
+
+    if (info->sUpdateType == sUPDATE_TYPE_BEGIN)
+    {
+        event.flags_ |= mf_BookBegin;
+    }
+
+    if (info->sUpdateType == sUPDATE_TYPE_END)
+    {
+        event.flags_ |= mf_BookEnd;
+    }
+
+    if (info->bPriceFlag)
+    {
+        event.flags_ |= mf_BookLevel;
+        event.price_[0] = info->dPrice;
+        event.qty_[0] = info->bSizeFlag ? info->llSize : 0;
+    }
+
+    if (event.flags_)
+    {
+        dispatch(event);
+    }
+}
+
+void RithmicClient::applyBook(Symbol &symbol, const MDEvent &event)
+{
+    if (!symbol.book_)
+    {
+        return;
+    }
+
+    auto &book = *symbol.book_;
+    if (event.flags_ & mf_BookBegin)
+    {
+        book.begin();
+    }
+    if (event.flags_ & mf_BookClear)
+    {
+        book.clear(event.side_);
+    }
+    if (event.flags_ & mf_BookLevel)
+    {
+        book.update(event.side_, event.price_[0], event.qty_[0]);
+    }
+    if (event.flags_ & mf_BookEnd)
+    {
+        book.end();
+    }
+}
+
+int RithmicClient::AskQuote(RApi::AskInfo *pInfo, void *pContext, int *aiCode)
+{
+    CallbackTimer timer(ingress_stats_);
+    auto *sym = resolveSymbol(pInfo, pContext);
+    if (sym && sym->book_)
+    {
+        bookEvent(*sym, Side::Sell, pInfo);
+    }
     *aiCode = API_OK;
     return (OK);
 }
 
-int RithmicClient::MarketMode(RApi::MarketModeInfo *pInfo, void *pContext, int *aiCode)
+int RithmicClient::BidQuote(RApi::BidInfo *pInfo, void *pContext, int *aiCode)
 {
-    std::string sym = symbol(pInfo);
-    SPDLOG_INFO("MarketMode: {} marketMode={} event={} reason={}", sym, std::string(pInfo->sMarketMode.pData, pInfo->sMarketMode.iDataLen),
-        std::string(pInfo->sEvent.pData, pInfo->sEvent.iDataLen), std::string(pInfo->sReason.pData, pInfo->sReason.iDataLen));
-    auto iter = symbols_.find(sym);
-    if (iter != symbols_.end())
+    CallbackTimer timer(ingress_stats_);
+    auto *sym = resolveSymbol(pInfo, pContext);
+    if (sym && sym->book_)
     {
-        auto status = to_string_view(pInfo->sMarketMode);
-        iter->second.can_trade_.exchange(status == "Open" || status == "Pre Open", std::memory_order_acq_rel);
+        bookEvent(*sym, Side::Buy, pInfo);
     }
-    setMDReady(iter->second, MDReady::Status);
     *aiCode = API_OK;
     return (OK);
 }
 
+int RithmicClient::LimitOrderBook(RApi::LimitOrderBookInfo *pInfo, void *pContext, int *aiCode)
+{
+    if (pInfo->iRpCode != API_OK)
+    {
+        SPDLOG_INFO("LimitOrderBook {} err: {}", to_string_view(pInfo->sTicker), to_string_view(pInfo->sRpCode));
+        *aiCode = API_OK;
+        return (OK);
+    }
+
+    auto *sym = resolveSymbol(pInfo, pContext);
+    if (sym && sym->book_)
+    {
+        // the rebuild goes through the same path as the incremental updates so the book keeps a single writer
+        MDEvent event{MDEventType::Book};
+        event.handle_ = sym->handle_;
+        event.side_ = Side::Buy;
+        event.flags_ = mf_BookBegin | mf_BookClear;
+        dispatch(event);
+        event.side_ = Side::Sell;
+        event.flags_ = mf_BookClear;
+        dispatch(event);
+
+        event.flags_ = mf_BookLevel;
+        event.side_ = Side::Buy;
+        for (auto i = 0; i < pInfo->iBidArrayLen; ++i)
+        {
+            event.price_[0] = pInfo->adBidPriceArray[i];
+            event.qty_[0] = pInfo->allBidSizeArray[i];
+            dispatch(event);
+        }
+        event.side_ = Side::Sell;
+        for (auto i = 0; i < pInfo->iAskArrayLen; ++i)
+        {
+            event.price_[0] = pInfo->adAskPriceArray[i];
+            event.qty_[0] = pInfo->allAskSizeArray[i];
+            dispatch(event);
+        }
+
+        event.flags_ = mf_BookEnd;
+        dispatch(event);
+        SPDLOG_DEBUG("{} book rebuilt. bids={} asks={}", sym->spec_.symbol_, pInfo->iBidArrayLen, pInfo->iAskArrayLen);
+    }
+    *aiCode = API_OK;
+    return (OK);
+}
+
+uint32_t RithmicClient::getTrades(const char* asset, TradeQuery &query)
+{
+    auto *sym = getSymbol(asset);
+    if (!sym || !sym->trades_ || !query.ticks || query.max_ticks <= 0)
+    {
+        return 0;
+    }
+    requirePrints(*sym);
+
+    auto *out = query.ticks;
+    auto copy = [&out](uint64_t seq, const Trade &trade) {
+        out->seq = (double)seq;
+        out->time = (DATE)(trade.time_ / 1000000000) / 86400. + 25569.;
+        out->nanos = (int)(trade.time_ % 1000000000);
+        out->price = trade.price_;
+        out->size = (double)trade.qty_;
+        out->side = (int)trade.side_;
+        ++out;
+    };
+
+    if (query.last_n > 0)
+    {
+        return sym->trades_->readLast(std::min(query.last_n, query.max_ticks), copy);
+    }
+    return sym->trades_->readSince(query.since_seq > 0 ? (uint64_t)query.since_seq : 0, query.max_ticks, copy);
+}
+
+int RithmicClient::getBook(const char* asset, T2 *quotes, int max_quotes)
+{
+    auto *sym = getSymbol(asset);
+    if (!sym || !sym->book_)
+    {
+        return 0;
+    }
+    auto n = sym->book_->snapshot(quotes, max_quotes, get_date());
+    if (n < 0)
+    {
+        // the depth stream kept updating the book, no consistent copy
+        SPDLOG_DEBUG("{} book busy", asset);
+        return 0;
+    }
+    return n;
+}
+
 std::vector<Spec> RithmicClient::searchInstrument(const std::string &search)
 {
-    auto iter = symbols_.find(search);
-    if (iter != symbols_.end())
+    auto *sym = getSymbol(search);
+    if (sym)
     {
-        return {iter->second.spec_};
+        return {sym->spec_};
     }
 
     std::regex re("[\\-]");
@@ -21,6 +21,7 @@
 
 #include "stdafx.h"
 #include "client.h"
+#include "config.h"
 #include "utils.h"
 #include "global.h"
 
@@ -29,67 +30,214 @@ using namespace RApi;
 
 namespace {
     auto &global = zorro::Global::get();
+
+    OrderType toOrderType(const tsNCharcb &type)
+    {
+        if (!type.pData || !type.iDataLen)
+        {
+            return OrderType::Unknown;
+        }
+        if (type == (tsNCharcb)sORDER_TYPE_LIMIT)
+        {
+            return OrderType::Limit;
+        }
+        if (type == (tsNCharcb)sORDER_TYPE_MARKET)
+        {
+            return OrderType::Market;
+        }
+        if (type == (tsNCharcb)sORDER_TYPE_STOP_LIMIT)
+        {
+            return OrderType::StopLimit;
+        }
+        if (type == (tsNCharcb)sORDER_TYPE_STOP_MARKET)
+        {
+            return OrderType::StopMarket;
+        }
+        return OrderType::Other;
+    }
+
+    Duration toDuration(const tsNCharcb &duration)
+    {
+        if (duration == (tsNCharcb)sORDER_DURATION_GTC)
+        {
+            return Duration::GTC;
+        }
+        if (duration == (tsNCharcb)sORDER_DURATION_FOK)
+        {
+            return Duration::FOK;
+        }
+        if (duration == (tsNCharcb)sORDER_DURATION_IOC)
+        {
+            return Duration::IOC;
+        }
+        return Duration::Day;
+    }
+
+    CompletionReason toCompletionReason(const tsNCharcb &reason)
+    {
+        if (!reason.pData || !reason.iDataLen)
+        {
+            return CompletionReason::None;
+        }
+        if (reason == (tsNCharcb)sCOMPLETION_REASON_FILL)
+        {
+            return CompletionReason::Fill;
+        }
+        if (reason == (tsNCharcb)sCOMPLETION_REASON_PFBC)
+        {
+            return CompletionReason::PartialFillBeforeCancel;
+        }
+        if (reason == (tsNCharcb)sCOMPLETION_REASON_CANCEL)
+        {
+            return CompletionReason::Cancel;
+        }
+        if (reason == (tsNCharcb)sCOMPLETION_REASON_REJECT)
+        {
+            return CompletionReason::Reject;
+        }
+        if (reason == (tsNCharcb)sCOMPLETION_REASON_FAILURE)
+        {
+            return CompletionReason::Failure;
+        }
+        return CompletionReason::Other;
+    }
+
+    // how long an order entry holds the Zorro thread, per entry mode
+    class EntryTimer
+    {
+        OrderReportStats &stats_;
+        const bool async_;
+        std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+    public:
+        EntryTimer(OrderReportStats &stats, bool async) noexcept : stats_(stats), async_(async) {}
+        ~EntryTimer()
+        {
+            auto ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+            stats_.entries_[async_].fetch_add(1, std::memory_order_relaxed);
+            stats_.entry_ns_[async_].fetch_add(ns, std::memory_order_relaxed);
+        }
+    };
+
+    OrderStatus toOrderStatus(const tsNCharcb &status, CompletionReason reason)
+    {
+        if (reason != CompletionReason::None)
+        {
+            return OrderStatus::Complete;
+        }
+        if (!status.pData || !status.iDataLen)
+        {
+            return OrderStatus::Unknown;
+        }
+        return status == (tsNCharcb)sLINE_STATUS_OPEN ? OrderStatus::Open : OrderStatus::Other;
+    }
 }
 
-std::shared_ptr<Order> RithmicClient::getOrder(uint32_t order_id) const
+Order* RithmicClient::getOrder(uint32_t order_id) const
 {
-    auto iter = orders_by_id_.find(order_id);
-    if (iter == orders_by_id_.end())
+    uint32_t handle;
     {
-        return nullptr;
+        std::lock_guard lock(orders_mutex_);
+        auto iter = orders_by_id_.find(order_id);
+        if (iter == orders_by_id_.end())
+        {
+            return nullptr;
+        }
+        handle = iter->second;
+    }
+
+    auto *order = orders_.get(handle);
+    if (order)
+    {
+        order->last_access_ms_.store(get_timestamp(), std::memory_order_relaxed);
     }
-    return iter->second->load(std::memory_order_relaxed);
+    return order;
 }
 
-std::shared_ptr<Order> RithmicClient::retrieveOrder(uint32_t order_id)
+void RithmicClient::mapOrder(uint32_t trade_id, uint32_t handle)
 {
-    auto order = getOrder(order_id);
-    if (order)
+    std::lock_guard lock(orders_mutex_);
+    orders_by_id_[trade_id] = handle;
+}
+
+Order* RithmicClient::retrieveOrder(uint32_t order_id)
+{
+    auto *order = getOrder(order_id);
+    if (order_id < PROVISIONAL_ID_BASE)
     {
-        return order;
+        return order ? order : replayOrder(order_id, order_id);
     }
 
-    order = std::make_shared<Order>();
-    order->client_order_id_ = 0;
-    order->order_num_ = order_id;
-    order->str_order_num_ = std::to_string(order_id);
+    // provisional id of an asynchronous order, recorded with its order number once it is acknowledged
+    // so the order can still be found after a re-login or a restart
+    uint32_t order_num;
+    {
+        std::lock_guard lock(orders_mutex_);
+        if (order)
+        {
+            order_num = order->state_.load().order_num_;
+            if (order_num)
+            {
+                provisional_ids_.resolve(order_id, order_num, get_timestamp() / 1000);
+            }
+            return order;
+        }
+        order_num = provisional_ids_.orderNum(order_id);
+    }
+    return order_num ? replayOrder(order_num, order_id) : nullptr;
+}
 
-    auto order_index = next_order_index_.fetch_add(1, std::memory_order_relaxed);
+Order* RithmicClient::replayOrder(uint32_t order_id, uint32_t trade_id)
+{
+    auto *order = orders_.allocate();
+    if (!order)
+    {
+        BrokerError(std::format("Order store is full, can't retrieve order {}", order_id).c_str());
+        return nullptr;
+    }
 
-    auto &atomic_order = orders_[order_index];
-    atomic_order.store(order, std::memory_order_relaxed);
+    auto handle = order->handle_.load(std::memory_order_relaxed);
+    order->last_access_ms_.store(get_timestamp(), std::memory_order_relaxed);
+    OrderState state;
+    state.order_num_ = order_id;
+    order->state_.store(state);
 
-    tsNCharcb order_num {order->str_order_num_.data(), (int)order->str_order_num_.size()};
+    auto str_order_num = std::to_string(order_id);
+    tsNCharcb order_num {str_order_num.data(), (int)str_order_num.size()};
 
     int iCode;
-    if (!engine_->setOrderContext(&order_num, &atomic_order, &iCode))
+    if (!engine_->setOrderContext(&order_num, OrderPool::context(handle), &iCode))
     {
         BrokerError(std::format("Failed to set OrderContext. orderNum={} err: {}", order_id, iCode).c_str());
+        orders_.release(order);
         return nullptr;
     }
 
-    pending_order_request_.store(order_id, std::memory_order_relaxed);
-    if (!engine_->replaySingleOrder(&account_info_, &order_num, &atomic_order, &iCode))
+    order->requests_.fetch_or(or_Replay, std::memory_order_release);
+    if (!engine_->replaySingleOrder(&account_info_, &order_num, OrderPool::context(handle), &iCode))
     {
         BrokerError(std::format("REngine::replaySingleOrder() err: {}", iCode).c_str());
+        order->requests_.fetch_and((uint8_t)~or_Replay, std::memory_order_relaxed);
+        orders_.release(order);
         return nullptr;
     }
 
-    while (pending_order_request_.load(std::memory_order_relaxed))
+    if (waitOrder(waiter_, order, or_Replay, WaitSite::RetrieveOrder) != WaitResult::Done)
     {
-        if (!BrokerProgress(1))
-        {
-            return nullptr;
-        }
+        // the order is not mapped yet, a late replay is rejected by the released handle
+        orders_.release(order);
+        return nullptr;
     }
 
-    auto retrieved_order = atomic_order.load(std::memory_order_relaxed);
-    if (retrieved_order->client_order_id_ == 0)
+    if (order->client_order_id_ == 0)
     {
+        // not an order of this plugin
+        orders_.release(order);
         return nullptr;
     }
-    orders_by_id_[retrieved_order->order_num_] = &atomic_order;
-    return retrieved_order;
+    order->trade_id_ = trade_id;
+    mapOrder(trade_id, handle);
+    return order;
 }
 
 bool RithmicClient::subscribeOrder()
@@ -127,68 +275,83 @@ int RithmicClient::OpenOrderReplay(OrderReplayInfo *pInfo, void *pContext, int *
                 continue;
             }
 
-            auto order_index = next_order_index_.fetch_add(1, std::memory_order_relaxed);
-            uint32_t client_order_id = atoi(userTag.substr(6).data());
-
-            auto order = std::make_shared<Order>();
-            order->client_order_id_ = client_order_id;
-            order->exchange_ = to_string_view(line_info.sExchange);
-            order->ticker_ = to_string_view(line_info.sTicker);
-            order->symbol_ = symbol(&line_info);
-            order->exch_ord_id_ = to_string_view(line_info.sExchOrdId);
-            order->ticker_plant_exch_ord_id_ = to_string_view(line_info.sTickerPlantExchOrdId);
+            auto *order = orders_.allocate();
+            if (!order)
+            {
+                SPDLOG_ERROR("Order store is full. orderNum: {}", to_string_view(line_info.sOrderNum));
+                break;
+            }
 
-            order->side_ = strcmp(line_info.sBuySellType.pData, sBUY_SELL_TYPE_BUY.pData) == 0 ? Side::Buy : Side::Sell;
+            auto handle = order->handle_.load(std::memory_order_relaxed);
+            order->last_access_ms_.store(get_timestamp(), std::memory_order_relaxed);
+            order->client_order_id_ = atoll(userTag.substr(6).data());
+            char buf[64];
+            copyId(order->exchange_, line_info.sExchange);
+            copyId(order->ticker_, line_info.sTicker);
+            copyId(order->symbol_, symbol(&line_info, buf));
+            copyId(order->tag_, userTag);
+            copyId(order->trade_route_, line_info.sTradeRoute);
+            copyId(order->exch_ord_id_, line_info.sExchOrdId);
+            copyId(order->ticker_plant_exch_ord_id_, line_info.sTickerPlantExchOrdId);
+            copyId(order->original_order_num_, line_info.sOriginalOrderNum);
+            copyId(order->initial_sequence_number_, line_info.sInitialSequenceNumber);
+            copyId(order->current_sequence_number_, line_info.sCurrentSequenceNumber);
+            copyId(order->omni_bus_account_, line_info.sOmnibusAccount);
+
+            OrderState state;
+            OrderDetail detail;
+            state.side_ = strcmp(line_info.sBuySellType.pData, sBUY_SELL_TYPE_BUY.pData) == 0 ? Side::Buy : Side::Sell;
 
             if (line_info.bPriceToFillFlag)
             {
-                order->avg_fill_price_ = line_info.dPriceToFill;
+                state.avg_fill_price_ = line_info.dPriceToFill;
             }
 
             if (line_info.bAvgFillPriceFlag)
             {
-                order->avg_fill_price_ = line_info.dAvgFillPrice;
+                state.avg_fill_price_ = line_info.dAvgFillPrice;
             }
 
             if (line_info.bTriggerPriceFlag)
             {
-                order->trigger_price_ = line_info.dTriggerPrice;
+                detail.trigger_price_ = line_info.dTriggerPrice;
             }
 
-            order->qty_ = line_info.llQuantityToFill;
-            order->exec_qty_ = line_info.llFilled;
-            order->str_order_num_ = to_string_view(line_info.sOrderNum);
-            order->order_num_ = atoi(to_string_view(line_info.sOrderNum).data());
-            order->original_order_num_ = to_string_view(line_info.sOriginalOrderNum);
-            order->initial_sequence_number_ = to_string_view(line_info.sInitialSequenceNumber);
-            order->current_sequence_number_ = to_string_view(line_info.sCurrentSequenceNumber);
-            order->omni_bus_account_ = to_string_view(line_info.sOmnibusAccount);
-            order->order_type_ = line_info.sOrderType;
-            order->original_order_type_ = line_info.sOriginalOrderType;
-            order->duration_ = line_info.sOrderDuration;
-            order->trade_route_ = line_info.sTradeRoute;
-
-            orders_[order_index].store(order, std::memory_order_release);   // store the order
-
-            if (!engine_->setOrderContext(&line_info.sOrderNum, &orders_[order_index], &iCode))
+            state.qty_ = line_info.llQuantityToFill;
+            state.exec_qty_ = line_info.llFilled;
+            state.order_num_ = atoi(to_string_view(line_info.sOrderNum).data());
+            auto provisional_id = provisionalId(userTag);
+            order->trade_id_ = provisional_id ? provisional_id : state.order_num_;
+            state.order_type_ = toOrderType(line_info.sOrderType);
+            state.duration_ = toDuration(line_info.sOrderDuration);
+            state.completion_reason_ = toCompletionReason(line_info.sCompletionReason);
+            state.status_ = toOrderStatus(line_info.sStatus, state.completion_reason_);
+            detail.original_order_type_ = toOrderType(line_info.sOriginalOrderType);
+            order->state_.store(state);
+            order->detail_.store(detail);
+
+            if (!engine_->setOrderContext(&line_info.sOrderNum, OrderPool::context(handle), &iCode))
             {
-                SPDLOG_ERROR("REngine::setOrderContext() failed. orderNum: {} order_index: {} err: {}", order->order_num_, order_index, iCode);
+                SPDLOG_ERROR("REngine::setOrderContext() failed. orderNum: {} handle: {:x} err: {}", state.order_num_, handle, iCode);
             }
         }
         request_status_.store(RequestStatus::Complete, std::memory_order_release);
+        waiter_.signal();
     }
     else
     {
         SPDLOG_DEBUG(to_string_view(pInfo->sRpCode));
         request_status_.store(RequestStatus::Failed, std::memory_order_release);
+        waiter_.signal();
     }
     *aiCode = API_OK;
     return (OK);
 }
 
-std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendOrder(const char* asset, Side side, int quantity, double price, const tsNCharcb &duration, double trigger_price, bool is_short)
+std::pair<Order*, bool> RithmicClient::sendOrder(const char* asset, Side side, int quantity, double price, const tsNCharcb &duration, double trigger_price, bool is_short)
 {
-    auto *symbol = getSymbol(asset);
+    // only the fields fixed when the symbol was published are read below
+    auto *symbol = findSymbol(asset);
     if (!symbol)
     {
         BrokerError(std::format("Symbol {} not found", asset).c_str());
@@ -224,7 +387,7 @@ std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendOrder(const char* ass
     return sendStopLimitOrder(symbol, side, quantity, price, trigger_price, duration, iter_trade_route->second, is_short);
 }
 
-std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendLimitOrder(Symbol *symbol, Side side, int quantity, double price, const tsNCharcb &duration, const std::string &trade_route, bool is_short)
+std::pair<Order*, bool> RithmicClient::sendLimitOrder(Symbol *symbol, Side side, int quantity, double price, const tsNCharcb &duration, const std::string &trade_route, bool is_short)
 {
     LimitOrderParams params;
     params.dPrice = price;
@@ -244,7 +407,7 @@ std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendLimitOrder(Symbol *sy
     return doSendOrder(params, side, price, quantity);
 }
 
-std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendMarketOrder(Symbol *symbol, Side side, int quantity, const std::string &trade_route, bool is_short)
+std::pair<Order*, bool> RithmicClient::sendMarketOrder(Symbol *symbol, Side side, int quantity, const std::string &trade_route, bool is_short)
 {
     MarketOrderParams params;
     params.pAccount = &account_info_;
@@ -261,7 +424,7 @@ std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendMarketOrder(Symbol *s
     return doSendOrder(params, side, NAN, quantity);
 }
 
-std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendStopLimitOrder(Symbol *symbol, Side side, int quantity, double price, double trigger_price, const tsNCharcb &duration, const std::string &trade_route, bool is_short)
+std::pair<Order*, bool> RithmicClient::sendStopLimitOrder(Symbol *symbol, Side side, int quantity, double price, double trigger_price, const tsNCharcb &duration, const std::string &trade_route, bool is_short)
 {
     StopLimitOrderParams params;
     params.pAccount = &account_info_;
@@ -280,7 +443,7 @@ std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendStopLimitOrder(Symbol
     return doSendOrder(params, side, price, quantity);
 }
 
-std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendStopMarketOrder(Symbol *symbol, Side side, int quantity, double trigger_price, const std::string &trade_route, bool is_short)
+std::pair<Order*, bool> RithmicClient::sendStopMarketOrder(Symbol *symbol, Side side, int quantity, double trigger_price, const std::string &trade_route, bool is_short)
 {
     StopMarketOrderParams params;
     params.pAccount = &account_info_;
@@ -299,28 +462,50 @@ std::pair<std::shared_ptr<Order>, bool> RithmicClient::sendStopMarketOrder(Symbo
 }
 
 template<typename ParamT>
-std::pair<std::shared_ptr<Order>, bool> RithmicClient::doSendOrder(ParamT &params, Side side, double price, int qty)
+std::pair<Order*, bool> RithmicClient::doSendOrder(ParamT &params, Side side, double price, int qty)
 {
-    auto order = std::make_shared<Order>();
-    order->side_ = side;
-    order->price_ = price;
-    order->qty_ = qty;
-    order->exchange_ = to_string_view(params.sExchange);
-    order->ticker_ = to_string_view(params.sTicker);
-    order->symbol_ = symbol(&params);
-
-    auto order_index = next_order_index_.fetch_add(1, std::memory_order_relaxed);
-    auto client_order_id = pid_ << 32 | order_index;
+    auto *order = orders_.allocate();
+    if (!order)
+    {
+        BrokerError("Order store is full");
+        return std::make_pair(nullptr, false);
+    }
+
+    auto handle = order->handle_.load(std::memory_order_relaxed);
+    auto client_order_id = pid_ << 32 | handle;   // differs between generations of a slot
+    order->last_access_ms_.store(get_timestamp(), std::memory_order_relaxed);
+    char buf[64];
+    copyId(order->exchange_, params.sExchange);
+    copyId(order->ticker_, params.sTicker);
+    copyId(order->symbol_, symbol(&params, buf));
+    copyId(order->trade_route_, params.sTradeRoute);
     order->client_order_id_ = client_order_id;
-    order->tag_ = std::format("ZORRO_{}", client_order_id);
-    order->duration_ = params.sDuration;
 
-    auto &atomic_order = orders_[order_index];
-    atomic_order.store(order, std::memory_order_relaxed);
+    OrderState state;
+    state.side_ = side;
+    state.price_ = price;
+    state.qty_ = qty;
+    state.duration_ = toDuration(params.sDuration);
+    order->state_.store(state);
 
-    params.sTag.pData = order->tag_.data();
-    params.sTag.iDataLen = static_cast<int>(order->tag_.length());
-    params.pContext = &atomic_order;
+    // FOK and IOC orders are final when they return, they always wait
+    bool async = global.async_orders_ && state.duration_ != Duration::FOK && state.duration_ != Duration::IOC;
+    EntryTimer timer(order_report_stats_, async);
+
+    // the provisional id goes into the tag, the open order replay of a later session recovers it from there
+    uint32_t provisional_id = 0;
+    if (async)
+    {
+        std::lock_guard lock(orders_mutex_);
+        provisional_id = provisional_ids_.issue(get_timestamp() / 1000);
+    }
+    auto tag_end = (provisional_id ? std::format_to_n(order->tag_, sizeof(order->tag_) - 1, "ZORRO_{}_{}", client_order_id, provisional_id)
+        : std::format_to_n(order->tag_, sizeof(order->tag_) - 1, "ZORRO_{}", client_order_id)).out;
+    *tag_end = 0;
+
+    params.sTag.pData = order->tag_;
+    params.sTag.iDataLen = static_cast<int>(tag_end - order->tag_);
+    params.pContext = OrderPool::context(handle);
 
     if (!global.order_text_.empty())
     {
@@ -328,70 +513,75 @@ std::pair<std::shared_ptr<Order>, bool> RithmicClient::doSendOrder(ParamT &param
         params.sUserMsg.iDataLen = static_cast<int>(global.order_text_.length());
     }
 
-    SPDLOG_DEBUG("Send order. ZORRO_{} side={} price={} qty={} duration={}", client_order_id, (int)side, price, qty, to_string_view(params.sDuration));
-    pending_order_request_.store(client_order_id, std::memory_order_release);
+    SPDLOG_DEBUG("Send order. {} side={} price={} qty={} duration={}", order->tag_, (int)side, price, qty, to_string_view(params.sDuration));
+    if (!async)
+    {
+        order->requests_.fetch_or(or_Send, std::memory_order_release);
+    }
     int iCode;
     if (!engine_->sendOrder(&params, &iCode))
     {
         BrokerError(std::format("REngine::sendOrder() err: {}", iCode).c_str());
+        orders_.release(order);
         return std::make_pair(nullptr, false);
     }
 
-    auto start = get_timestamp();
-    while (pending_order_request_.load(std::memory_order_relaxed))
+    if (async)
     {
-        if (!BrokerProgress(1))
-        {
-            SPDLOG_DEBUG("BrokerProgress failed");
-            return std::make_pair(nullptr, false);
-        }
+        // fills and the final status are picked up by BrokerTrade
+        order->trade_id_ = provisional_id;
+        mapOrder(provisional_id, handle);
+        return std::make_pair(order, false);
+    }
 
-        if ((get_timestamp() - start) >= global.wait_time_)
+    auto result = waitOrder(waiter_, order, or_Send, WaitSite::SendOrder, global.wait_time_ / 1000000);  // wait_time_ is in ns
+    if (result == WaitResult::Aborted)
+    {
+        SPDLOG_DEBUG("BrokerProgress failed");
+        return std::make_pair(nullptr, false);
+    }
+
+    if (result == WaitResult::Timeout)
+    {
+        if (!std::isnan(price))
         {
-            if (!std::isnan(price))
+            // limit order. Whoever sees both the flag and the order number cancels it,
+            // either here or the report callback that stores the order number.
+            order->pending_cancel_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto order_num = order->state_.load().order_num_;
+            if (order_num && order->pending_cancel_.exchange(false, std::memory_order_relaxed))
             {
-                // limit order
-                auto ord = atomic_order.load(std::memory_order_relaxed);
-                std::shared_ptr<Order> new_order;
-                do
-                {
-                    if (ord->order_num_)
-                    {
-                        cancelOrder(ord->order_num_);
-                        break;
-                    }
-                    new_order = std::make_shared<Order>(*ord.get());
-                    new_order->pending_cancel_ = true;
-                }
-                while (!atomic_order.compare_exchange_weak(ord, new_order, std::memory_order_release, std::memory_order_relaxed));
+                order->trade_id_ = order_num;
+                mapOrder(order_num, handle);
+                cancelOrder(order_num);
             }
-            pending_order_request_.store(0, std::memory_order_relaxed);
-            return std::make_pair(nullptr, true);
         }
+        return std::make_pair(nullptr, true);
     }
 
-    auto updated_order = atomic_order.load(std::memory_order_relaxed);
-    if (!updated_order->text_.empty())
+    auto detail = order->detail_.load();
+    if (detail.text_[0])
     {
-        BrokerError(updated_order->text_.c_str());
+        BrokerError(detail.text_);
     }
 
-    if (updated_order->order_num_ == 0)
+    auto updated = order->state_.load();
+    if (updated.order_num_ == 0)
     {
         return std::make_pair(nullptr, false);
     }
 
-    if (updated_order->completion_reason_.pData)
+    if (updated.completion_reason_ != CompletionReason::None &&
+        updated.completion_reason_ != CompletionReason::Fill &&
+        updated.completion_reason_ != CompletionReason::PartialFillBeforeCancel)
     {
-        if (updated_order->completion_reason_ != (tsNCharcb)sCOMPLETION_REASON_FILL &&
-            updated_order->completion_reason_ != (tsNCharcb)sCOMPLETION_REASON_PFBC)
-        {
-            // Order cancelled, rejected or failed
-            return std::make_pair(nullptr, false);
-        }
+        // Order cancelled, rejected or failed
+        return std::make_pair(nullptr, false);
     }
-    orders_by_id_[updated_order->order_num_] = &atomic_order;
-    return std::make_pair(updated_order, false);
+    order->trade_id_ = updated.order_num_;
+    mapOrder(updated.order_num_, handle);
+    return std::make_pair(order, false);
 }
 
 int RithmicClient::LineUpdate(LineInfo *pInfo, void *pContext, int *aiCode)
@@ -414,10 +604,10 @@ int RithmicClient::LineUpdate(LineInfo *pInfo, void *pContext, int *aiCode)
             to_string_view(pInfo->sStatus), to_string_view(pInfo->sCompletionReason), to_string_view(pInfo->sRemarks), to_string_view(pInfo->sText),
             to_string_view(pInfo->sUserTag), to_string_view(pInfo->sUserMsg));
 
-        auto *atomic_order = static_cast<std::atomic<std::shared_ptr<Order>>*>(pInfo->pContext);
-        if (!atomic_order || atomic_order < &orders_.front() || atomic_order > &orders_.back())
+        auto order = orders_.pin(pInfo->pContext);
+        if (!order)
         {
-            // order placed by other application
+            // order placed by other application or of a retired slot
             *aiCode = API_OK;
             return OK;
         }
@@ -429,13 +619,13 @@ int RithmicClient::LineUpdate(LineInfo *pInfo, void *pContext, int *aiCode)
             return OK;
         }
 
-        auto order = atomic_order->load(std::memory_order_relaxed);
-        std::shared_ptr<Order> updated_order;
+        CallbackTimer timer(order_report_stats_);
+        auto state = order->state_.load();
         auto order_num = atoi(to_string_view(pInfo->sOrderNum).data());
         if (pInfo->iType == RApi::MD_HISTORY_CB)
         {
             // from replay
-            assert(order->order_num_ == order_num);
+            assert(state.order_num_ == order_num);
         }
         else
         {
@@ -448,94 +638,91 @@ int RithmicClient::LineUpdate(LineInfo *pInfo, void *pContext, int *aiCode)
             }
         }
 
-        do
+        // stale information is dropped
+        auto detail = order->detail_.load();
+        bool updated = detail.last_update_time_ <= order_timestamp;
+        if (updated)
         {
-            if(order->last_update_time_ > order_timestamp)
-            {
-                // stale information
-                break;
-            }
-
-            if (order->pending_cancel_)
-            {
-                int iCode;
-                if (!engine_->cancelOrder(&account_info_, &pInfo->sOrderNum, (tsNCharcb*)&sORDER_ENTRY_TYPE_AUTO, nullptr, nullptr, nullptr, &iCode))
-                {
-                    auto msg = std::format("Pending cancel, failed to cancel. {} {} {}. err: {}", to_string_view(pInfo->sTicker), to_string_view(pInfo->sTag), order_num, iCode);
-                    SPDLOG_ERROR(msg);
-                    BrokerError(msg.c_str());
-                }
-                order->pending_cancel_ = false;
-                *aiCode = API_OK;
-                return OK;
-            }
-
-            updated_order = std::make_shared<Order>(*order.get());
-
             if (pInfo->iType == RApi::MD_HISTORY_CB)
             {
-                if (updated_order->tag_.empty())
+                if (!order->tag_[0])
                 {
-                    updated_order->exchange_ = to_string_view(pInfo->sExchange);
-                    updated_order->ticker_ = to_string_view(pInfo->sTicker);
-                    updated_order->symbol_ = symbol(pInfo);
-                    updated_order->tag_ = to_string_view(pInfo->sTag);
-                    updated_order->client_order_id_ = client_order_id;
+                    // retrieveOrder() waits until the replay completes
+                    char buf[64];
+                    copyId(order->exchange_, pInfo->sExchange);
+                    copyId(order->ticker_, pInfo->sTicker);
+                    copyId(order->symbol_, symbol(pInfo, buf));
+                    copyId(order->tag_, pInfo->sTag);
+                    order->client_order_id_ = client_order_id;
                 }
             }
             else
             {
-                updated_order->str_order_num_ = to_string_view(pInfo->sOrderNum);
-                updated_order->order_num_ = order_num;
+                state.order_num_ = order_num;
             }
 
             if (pInfo->bPriceToFillFlag)
             {
-                updated_order->price_ = pInfo->dPriceToFill;
+                state.price_ = pInfo->dPriceToFill;
             }
 
             if (pInfo->bAvgFillPriceFlag)
             {
-                updated_order->avg_fill_price_ = pInfo->dAvgFillPrice;
+                state.avg_fill_price_ = pInfo->dAvgFillPrice;
             }
 
             if (pInfo->bTriggerPriceFlag)
             {
-                updated_order->trigger_price_ = pInfo->dTriggerPrice;
+                detail.trigger_price_ = pInfo->dTriggerPrice;
             }
 
-            updated_order->qty_ = pInfo->llQuantityToFill;
-            updated_order->exec_qty_ = pInfo->llFilled;
-            updated_order->original_order_num_ = to_string_view(pInfo->sOriginalOrderNum);
-            updated_order->initial_sequence_number_ = to_string_view(pInfo->sInitialSequenceNumber);
-            updated_order->current_sequence_number_ = to_string_view(pInfo->sCurrentSequenceNumber);
-            updated_order->omni_bus_account_ = to_string_view(pInfo->sOmnibusAccount);
-            updated_order->order_type_ = pInfo->sOrderType;
-            updated_order->original_order_type_ = pInfo->sOriginalOrderType;
-            updated_order->trade_route_ = pInfo->sTradeRoute;
-            updated_order->exch_ord_id_ = to_string_view(pInfo->sExchOrdId);
-            updated_order->ticker_plant_exch_ord_id_ = to_string_view(pInfo->sTickerPlantExchOrdId);
-            updated_order->last_update_time_ = order_timestamp;
-            updated_order->status_, pInfo->sStatus;
-            updated_order->completion_reason_ = pInfo->sCompletionReason;
-        } while (!atomic_order->compare_exchange_weak(order, updated_order, std::memory_order_release, std::memory_order_relaxed));
-        
-        if (pInfo->iType != RApi::MD_HISTORY_CB &&
-            ((pInfo->sCompletionReason.pData && pInfo->sCompletionReason.iDataLen) /*completed*/ || 
-             (updated_order && (updated_order->duration_ == (tsNCharcb)sORDER_DURATION_DAY || updated_order->duration_ == (tsNCharcb)sORDER_DURATION_GTC) &&
-               pInfo->sOrderType != sORDER_TYPE_MARKET && pInfo->sOrderType != sORDER_TYPE_STOP_MARKET && pInfo->sStatus == (tsNCharcb)sLINE_STATUS_OPEN)) &&
-            pending_order_request_.load(std::memory_order_relaxed) == client_order_id)
+            state.qty_ = pInfo->llQuantityToFill;
+            state.exec_qty_ = pInfo->llFilled;
+            state.order_type_ = toOrderType(pInfo->sOrderType);
+            state.completion_reason_ = toCompletionReason(pInfo->sCompletionReason);
+            state.status_ = toOrderStatus(pInfo->sStatus, state.completion_reason_);
+            detail.original_order_type_ = toOrderType(pInfo->sOriginalOrderType);
+            detail.last_update_time_ = order_timestamp;
+            copyId(order->trade_route_, pInfo->sTradeRoute);
+            copyId(order->original_order_num_, pInfo->sOriginalOrderNum);
+            copyId(order->initial_sequence_number_, pInfo->sInitialSequenceNumber);
+            copyId(order->current_sequence_number_, pInfo->sCurrentSequenceNumber);
+            copyId(order->omni_bus_account_, pInfo->sOmnibusAccount);
+            copyId(order->exch_ord_id_, pInfo->sExchOrdId);
+            copyId(order->ticker_plant_exch_ord_id_, pInfo->sTickerPlantExchOrdId);
+            order->detail_.store(detail);
+            order->state_.store(state);
+
+            // pairs with the fence in doSendOrder(), one side sees both the flag and the order number
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (order->pending_cancel_.load(std::memory_order_relaxed) && order->pending_cancel_.exchange(false, std::memory_order_relaxed))
+            {
+                SPDLOG_INFO("Pending cancel. {} {} {}", to_string_view(pInfo->sTicker), to_string_view(pInfo->sTag), order_num);
+                dispatch(CancelEvent{state.order_num_});
+            }
+        }
+
+        if (pInfo->iType != RApi::MD_HISTORY_CB)
         {
-            SPDLOG_DEBUG("LineUpdate: Reset pending order request");
-            pending_order_request_.store(0, std::memory_order_relaxed);
+            if (pInfo->sCompletionReason.pData && pInfo->sCompletionReason.iDataLen)
+            {
+                completeOrder(waiter_, order, or_Send | or_Cancel);
+            }
+            else if (updated && (state.duration_ == Duration::Day || state.duration_ == Duration::GTC) &&
+                state.order_type_ != OrderType::Market && state.order_type_ != OrderType::StopMarket && state.status_ == OrderStatus::Open)
+            {
+                // a resting order is accepted once it is open
+                completeOrder(waiter_, order, or_Send);
+            }
         }
     }
     else
     {
         SPDLOG_DEBUG(to_string_view(pInfo->sRpCode));
-        if (pInfo->iType != RApi::MD_HISTORY_CB && pending_order_request_.load(std::memory_order_relaxed) == client_order_id)
+        auto order = orders_.pin(pInfo->pContext);
+        if (pInfo->iType != RApi::MD_HISTORY_CB && order && order->client_order_id_ == client_order_id)
         {
-            pending_order_request_.store(0, std::memory_order_relaxed);
+            completeOrder(waiter_, order, or_Send | or_Cancel);
         }
     }
     *aiCode = API_OK;
@@ -544,10 +731,11 @@ int RithmicClient::LineUpdate(LineInfo *pInfo, void *pContext, int *aiCode)
 
 int RithmicClient::SingleOrderReplay(RApi::SingleOrderReplayInfo *pInfo, void *pContext, int *aiCode)
 {
-    auto order_num = atoi(to_string_view(pInfo->sOrderNum).data());
-    if (pending_order_request_.load(std::memory_order_relaxed) == order_num)
+    // pContext is the handle passed to replaySingleOrder()
+    auto order = orders_.pin(pContext);
+    if (order)
     {
-        pending_order_request_.store(0, std::memory_order_release);
+        completeOrder(waiter_, order, or_Replay);
     }
     else
     {
@@ -578,15 +766,14 @@ int RithmicClient::CancelReport(RApi::OrderCancelReport * pReport, void * pConte
     SPDLOG_INFO("CancelReport: {} {} order_num={} context={:x} exch_ord_id={}", to_string_view(pReport->sTicker), to_string_view(pReport->sTag),
         to_string_view(pReport->sOrderNum), reinterpret_cast<uintptr_t>(pReport->pContext), to_string_view(pReport->sExchOrdId));
 
-    auto *atomic_order = static_cast<std::atomic<std::shared_ptr<Order>>*>(pReport->pContext);
-    if (pReport->iType == RApi::MD_HISTORY_CB || !atomic_order || atomic_order < &orders_.front() || atomic_order > &orders_.back())
+    auto order = orders_.pin(pReport->pContext);
+    if (pReport->iType == RApi::MD_HISTORY_CB || !order)
     {
         // order from history or placed by other application
         *aiCode = API_OK;
         return OK;
     }
 
-    auto order = atomic_order->load(std::memory_order_relaxed);
     if (order->client_order_id_ != client_order_id)
     {
         SPDLOG_ERROR("ClientOrderId mismatch: {} {} orderNum: {} client_order_id: {} conext client_order_id: {}", to_string_view(pReport->sTicker), to_string_view(pReport->sTag), to_string_view(pReport->sOrderNum),
@@ -595,20 +782,12 @@ int RithmicClient::CancelReport(RApi::OrderCancelReport * pReport, void * pConte
         return OK;
     }
 
-    std::shared_ptr<Order> updated_order;
-    auto order_num = atoi(to_string_view(pReport->sOrderNum).data());
-
-    do
-    {
-        updated_order = std::make_shared<Order>(*order.get());
-        updated_order->cancelled_ = true;
-    } while (!atomic_order->compare_exchange_weak(order, updated_order, std::memory_order_release, std::memory_order_relaxed));
-
-    if (pending_order_request_.load(std::memory_order_relaxed) == client_order_id)
     {
-        SPDLOG_DEBUG("CancelReport: Reset pending order request");
-        pending_order_request_.store(0, std::memory_order_relaxed);
+        CallbackTimer timer(order_report_stats_);
+        order->state_.update([](OrderState &state) { state.cancelled_ = true; });
     }
+
+    completeOrder(waiter_, order, or_Send | or_Cancel);
     *aiCode = API_OK;
     return OK;
 }
@@ -631,17 +810,14 @@ int RithmicClient::FailureReport(RApi::OrderFailureReport * pReport, void * pCon
     if (pReport->iType == RApi::MD_UPDATE_CB)
     {
         uint64_t client_order_id = atoll(tag.substr(6).data());
-        auto *atomic_order = static_cast<std::atomic<std::shared_ptr<Order>>*>(pReport->pContext);
-        if (!atomic_order || atomic_order < &orders_.front() || atomic_order > &orders_.back())
+        auto order = orders_.pin(pReport->pContext);
+        if (!order)
         {
             // order placed by other application
             *aiCode = API_OK;
             return OK;
         }
 
-        auto order = atomic_order->load(std::memory_order_relaxed);
-        std::shared_ptr<Order> updated_order;
-
         if (order->client_order_id_ != client_order_id)
         {
             SPDLOG_ERROR("ClientOrderId mismatch: {} {} orderNum: {} conext client_order_id: {}", to_string_view(pReport->sTicker), to_string_view(pReport->sTag), to_string_view(pReport->sOrderNum),
@@ -650,17 +826,12 @@ int RithmicClient::FailureReport(RApi::OrderFailureReport * pReport, void * pCon
             return OK;
         }
 
-        do
-        {
-            updated_order = std::make_shared<Order>(*order.get());
-            updated_order->text_ = to_string_view(pReport->sText);
-        } while (!atomic_order->compare_exchange_weak(order, updated_order, std::memory_order_release, std::memory_order_relaxed));
-        
-        if (pending_order_request_.load(std::memory_order_relaxed) == client_order_id)
         {
-            SPDLOG_DEBUG("FailureReport: Reset pending order request");
-            pending_order_request_.store(0, std::memory_order_relaxed);
+            CallbackTimer timer(order_report_stats_);
+            order->detail_.update([pReport](OrderDetail &detail) { copyId(detail.text_, pReport->sText); });
         }
+        
+        completeOrder(waiter_, order, or_Send | or_Cancel);
     }
 
     *aiCode = API_OK;
@@ -686,8 +857,8 @@ int RithmicClient::FillReport(RApi::OrderFillReport * pReport, void * pContext,
         return OK;
     }
 
-    auto *atomic_order = static_cast<std::atomic<std::shared_ptr<Order>>*>(pReport->pContext);
-    if (!atomic_order || atomic_order < &orders_.front() || atomic_order > &orders_.back())
+    auto order = orders_.pin(pReport->pContext);
+    if (!order)
     {
         // order placed by other application
         *aiCode = API_OK;
@@ -695,9 +866,6 @@ int RithmicClient::FillReport(RApi::OrderFillReport * pReport, void * pContext,
     }
 
     uint64_t client_order_id = atoll(tag.substr(6).data());
-    auto order = atomic_order->load(std::memory_order_relaxed);
-    std::shared_ptr<Order> updated_order;
-
     if (order->client_order_id_ != client_order_id)
     {
         SPDLOG_ERROR("ClientOrderId mismatch: {} {} orderNum: {} conext client_order_id: {}", to_string_view(pReport->sTicker), to_string_view(pReport->sTag), to_string_view(pReport->sOrderNum),
@@ -706,22 +874,24 @@ int RithmicClient::FillReport(RApi::OrderFillReport * pReport, void * pContext,
         return OK;
     }
 
-    do
+    CallbackTimer timer(order_report_stats_);
+    order->state_.update([pReport](OrderState &state)
     {
-        updated_order = std::make_shared<Order>(*order.get());
         if (pReport->bAvgFillPriceFlag)
         {
-            updated_order->avg_fill_price_ = pReport->dPriceToFill;
+            state.avg_fill_price_ = pReport->dAvgFillPrice;
         }
 
+        state.exec_qty_ = pReport->llTotalFilled;
+    });
+    order->detail_.update([pReport](OrderDetail &detail)
+    {
         if (pReport->bFillPriceFlag)
         {
-            updated_order->last_filled_price_ = pReport->bFillPriceFlag;
+            detail.last_filled_price_ = pReport->dFillPrice;
         }
-
-        updated_order->last_filled_qty_ = pReport->llFillSize;
-        updated_order->exec_qty_ = pReport->llTotalFilled;
-    } while (!atomic_order->compare_exchange_weak(order, updated_order, std::memory_order_release, std::memory_order_relaxed));
+        detail.last_filled_qty_ = pReport->llFillSize;
+    });
 
     *aiCode = API_OK;
     return OK;
@@ -771,8 +941,8 @@ int RithmicClient::RejectReport(RApi::OrderRejectReport * pReport, void * pConte
         to_string_view(pReport->sTicker), to_string_view(pReport->sTag), reinterpret_cast<uintptr_t>(pReport->pContext),
         to_string_view(pReport->sOrderNum), to_string_view(pReport->sExchOrdId), pReport->llRejectedSize, pReport->bReplacementOrderToFollow);
 
-    auto *atomic_order = static_cast<std::atomic<std::shared_ptr<Order>>*>(pReport->pContext);
-    if (!atomic_order || atomic_order < &orders_.front() || atomic_order > &orders_.back())
+    auto order = orders_.pin(pReport->pContext);
+    if (!order)
     {
         // order placed by other application
         *aiCode = API_OK;
@@ -780,9 +950,6 @@ int RithmicClient::RejectReport(RApi::OrderRejectReport * pReport, void * pConte
     }
 
     uint64_t client_order_id = atoll(tag.substr(6).data());
-    auto order = atomic_order->load(std::memory_order_relaxed);
-    std::shared_ptr<Order> updated_order;
-
     if (order->client_order_id_ != client_order_id)
     {
         SPDLOG_ERROR("ClientOrderId mismatch: {} {} orderNum: {} conext client_order_id: {}", to_string_view(pReport->sTicker), to_string_view(pReport->sTag), to_string_view(pReport->sOrderNum),
@@ -791,19 +958,13 @@ int RithmicClient::RejectReport(RApi::OrderRejectReport * pReport, void * pConte
         return OK;
     }
 
-    do
     {
-        updated_order = std::make_shared<Order>(*order.get());
-        updated_order->text_ = "Order Rejected";
-    } while (!atomic_order->compare_exchange_weak(order, updated_order, std::memory_order_release, std::memory_order_relaxed));
-    
-
-    if (pending_order_request_.load(std::memory_order_relaxed) == client_order_id)
-    {
-        SPDLOG_DEBUG("RejectReport: Reset pending order request");
-        pending_order_request_.store(0, std::memory_order_relaxed);
+        CallbackTimer timer(order_report_stats_);
+        order->detail_.update([](OrderDetail &detail) { copyId(detail.text_, "Order Rejected"); });
     }
 
+    completeOrder(waiter_, order, or_Send | or_Cancel);
+
     *aiCode = API_OK;
     return OK;
 }
@@ -843,43 +1004,139 @@ int RithmicClient::OtherReport(RApi::OrderReport * pReport, void * pContext, int
 
 bool RithmicClient::cancelOrder(uint32_t order_id)
 {
-    auto iter = orders_by_id_.find(order_id);
-    if (iter == orders_by_id_.end())
+    uint32_t handle = 0;
+    {
+        std::lock_guard lock(orders_mutex_);
+        auto iter = orders_by_id_.find(order_id);
+        if (iter != orders_by_id_.end())
+        {
+            handle = iter->second;
+        }
+    }
+    if (!handle)
+    {
+        BrokerError(std::format("Order {} not found", order_id).c_str());
+        return false;
+    }
+
+    auto *order = orders_.get(handle);
+    if (!order)
     {
         BrokerError(std::format("Order {} not found", order_id).c_str());
         return false;
     }
 
-    auto &atomic_order = *iter->second;
-    auto order = atomic_order.load(std::memory_order_relaxed);
-    if (order->cancelled_)
+    auto state = order->state_.load();
+    if (state.cancelled_)
     {
         return true;
     }
 
-    SPDLOG_INFO("Cancel order: {}", order_id);
-    tsNCharcb order_num { order->str_order_num_.data(), (int)order->str_order_num_.length() };
+    if (!state.order_num_)
+    {
+        // sent asynchronously and not acknowledged yet, the line update that brings
+        // the order number cancels it. Pairs with the fence in LineUpdate().
+        order->pending_cancel_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        state = order->state_.load();
+        if (!state.order_num_ || !order->pending_cancel_.exchange(false, std::memory_order_relaxed))
+        {
+            SPDLOG_INFO("Cancel order {} once acknowledged", order_id);
+            return true;
+        }
+    }
+
+    SPDLOG_INFO("Cancel order: {} orderNum: {}", order_id, state.order_num_);
+    auto str_order_num = std::to_string(state.order_num_);
+    tsNCharcb order_num { str_order_num.data(), (int)str_order_num.length() };
     int iCode;
-    pending_order_request_.store(order->client_order_id_, std::memory_order_relaxed);
-    if (!engine_->cancelOrder(&account_info_, &order_num, (tsNCharcb*)&sORDER_ENTRY_TYPE_AUTO, nullptr, nullptr, &atomic_order, &iCode))
+    order->requests_.fetch_or(or_Cancel, std::memory_order_release);
+    if (!engine_->cancelOrder(&account_info_, &order_num, (tsNCharcb*)&sORDER_ENTRY_TYPE_AUTO, nullptr, nullptr, OrderPool::context(handle), &iCode))
     {
         BrokerError(std::format("Failed to cancel {}. err: {}", order_id, iCode).c_str());
+        order->requests_.fetch_and((uint8_t)~or_Cancel, std::memory_order_relaxed);
         return false;
     }
 
-    while (pending_order_request_.load(std::memory_order_relaxed))
+    if (waitOrder(waiter_, order, or_Cancel, WaitSite::CancelOrder) != WaitResult::Done)
     {
-        if (!BrokerProgress(1))
-        {
-            return false;
-        }
+        return false;
     }
 
-    auto updated_order = atomic_order.load(std::memory_order_relaxed);
-    if (!updated_order->text_.empty())
+    auto detail = order->detail_.load();
+    if (detail.text_[0])
     {
-        BrokerError(updated_order->text_.c_str());
+        BrokerError(detail.text_);
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+void RithmicClient::retireOrders()
+{
+    static constexpr uint32_t RETIRE_BATCH = 1024;
+    static constexpr uint64_t RETIRE_INTERVAL_MS = 1000;
+
+    uint64_t retention_ms = Config::get().order_retention_min_ * 60000ull;
+    auto now = get_timestamp();
+    if (now < next_retire_ms_)
+    {
+        return;
+    }
+    next_retire_ms_ = now + RETIRE_INTERVAL_MS;
+    {
+        // provisional ids issued or resolved since the last pass
+        std::lock_guard lock(orders_mutex_);
+        provisional_ids_.save();
+    }
+    if (!retention_ms)
+    {
+        return;
+    }
+
+    auto n = orders_.size();
+    for (uint32_t i = 0; i < std::min(n, RETIRE_BATCH); ++i)
+    {
+        if (++retire_cursor_ >= n)
+        {
+            retire_cursor_ = 0;
+        }
+
+        auto *order = orders_.at(retire_cursor_);
+        if (!order || !order->handle_.load(std::memory_order_relaxed) ||
+            now < order->last_access_ms_.load(std::memory_order_relaxed) + retention_ms ||
+            order->pending_cancel_.load(std::memory_order_relaxed))
+        {
+            continue;
+        }
+
+        // orders without an order number were never accepted
+        auto state = order->state_.load();
+        if (state.order_num_ && !state.completed())
+        {
+            continue;
+        }
+
+        // a Zorro call may still be waiting on this order
+        if (order->requests_.load(std::memory_order_acquire))
+        {
+            continue;
+        }
+
+        {
+            std::lock_guard lock(orders_mutex_);
+            if (order->trade_id_ >= PROVISIONAL_ID_BASE && state.order_num_)
+            {
+                provisional_ids_.resolve(order->trade_id_, state.order_num_, now / 1000);
+            }
+            auto iter = orders_by_id_.find(order->trade_id_);
+            if (iter != orders_by_id_.end() && iter->second == order->handle_.load(std::memory_order_relaxed))
+            {
+                orders_by_id_.erase(iter);
+            }
+        }
+        SPDLOG_DEBUG("Retire order {} {} handle={:x}", state.order_num_, order->tag_, order->handle_.load(std::memory_order_relaxed));
+        orders_.release(order);
+        ++orders_retired_;
+    }
+}
@@ -59,31 +59,63 @@ int RithmicClient::PnlReplay(RApi::PnlReplayInfo *pInfo, void *pContext, int *ai
         double trade_value = 0.;
         for (auto i = 0; i < pInfo->iArrayLen; ++i)
         {
-            auto &pnl_info = pInfo->asPnlInfoArray[i];
-            handlePnlInfo(pnl_info);
+            // replay is applied inline, the request completes after all positions are known
+            PnlEvent event;
+            if (toPnlEvent(pInfo->asPnlInfoArray[i], event))
+            {
+                applyPnl(event);
+            }
         }
     }
     request_status_.store(RequestStatus::Complete, std::memory_order_release);
+    waiter_.signal();
     *aiCode = API_OK;
     return OK;
 }
 
 int RithmicClient::PnlUpdate(RApi::PnlInfo *pInfo, void *pContext, int *aiCode)
 {
-    handlePnlInfo(*pInfo);
+    PnlEvent event;
+    if (toPnlEvent(*pInfo, event))
+    {
+        dispatch(event);
+    }
     *aiCode = API_OK;
     return OK;
 }
 
-void RithmicClient::handlePnlInfo(const RApi::PnlInfo &pnl_info)
+bool RithmicClient::toPnlEvent(const RApi::PnlInfo &pnl_info, PnlEvent &event)
 {
-    auto iter = asset_position_.find(symbol(&pnl_info));
-    if (iter == asset_position_.end())
+    char buf[64];
+    auto *sym = findSymbol(symbol(&pnl_info, buf));
+    if (!sym)
     {
-        return;
+        return false;
     }
 
-    auto timestamp = nanosec(pnl_info);
+    event.handle_ = sym->handle_;
+    event.time_ = nanosec(pnl_info);
+    event.open_pnl_state_ = pnl_info.eOpenPnl;
+    event.open_pnl_ = pnl_info.dOpenPnl;
+    event.closed_pnl_state_ = pnl_info.eClosedPnl;
+    event.closed_pnl_ = pnl_info.dClosedPnl;
+    event.balance_state_ = pnl_info.eAccountBalance;
+    event.balance_ = pnl_info.dAccountBalance;
+    event.avg_price_state_ = pnl_info.eAvgOpenFillPrice;
+    event.avg_price_ = pnl_info.dAvgOpenFillPrice;
+    event.position_state_ = pnl_info.ePosition;
+    event.position_ = pnl_info.llPosition;
+    event.buy_qty_state_ = pnl_info.eBuyQty;
+    event.buy_qty_ = pnl_info.llBuyQty;
+    event.sell_qty_state_ = pnl_info.eSellQty;
+    event.sell_qty_ = pnl_info.llSellQty;
+    return true;
+}
+
+void RithmicClient::applyPnl(const PnlEvent &pnl_info)
+{
+    auto *sym = &symbols_[pnl_info.handle_];
+    auto timestamp = pnl_info.time_;
 
     auto pnl = pnl_.load(std::memory_order_relaxed);
     PnL new_pnl;
@@ -95,26 +127,26 @@ void RithmicClient::handlePnlInfo(const RApi::PnlInfo &pnl_info)
         }
         new_pnl.timestamp_ = timestamp;
 
-        if (pnl_info.eOpenPnl == VALUE_STATE_CLEAR)
+        if (pnl_info.open_pnl_state_ == VALUE_STATE_CLEAR)
         {
             new_pnl.unrealized_pnl_ = 0.;
         }
-        else if (pnl_info.eOpenPnl == VALUE_STATE_USE)
+        else if (pnl_info.open_pnl_state_ == VALUE_STATE_USE)
         {
-            new_pnl.unrealized_pnl_ = pnl_info.dOpenPnl;
+            new_pnl.unrealized_pnl_ = pnl_info.open_pnl_;
         }
         else
         {
             new_pnl.unrealized_pnl_ = pnl.unrealized_pnl_;
         }
 
-        if (pnl_info.eClosedPnl == VALUE_STATE_CLEAR)
+        if (pnl_info.closed_pnl_state_ == VALUE_STATE_CLEAR)
         {
             new_pnl.realized_pnl_ = 0.;
         }
-        else if (pnl_info.eClosedPnl == VALUE_STATE_USE)
+        else if (pnl_info.closed_pnl_state_ == VALUE_STATE_USE)
         {
-            new_pnl.realized_pnl_ = pnl_info.dClosedPnl;
+            new_pnl.realized_pnl_ = pnl_info.closed_pnl_;
         }
         else
         {
@@ -123,13 +155,13 @@ void RithmicClient::handlePnlInfo(const RApi::PnlInfo &pnl_info)
 
         new_pnl.pnl_ = new_pnl.realized_pnl_ + new_pnl.unrealized_pnl_;
 
-        if (pnl_info.eAccountBalance == VALUE_STATE_CLEAR)
+        if (pnl_info.balance_state_ == VALUE_STATE_CLEAR)
         {
             new_pnl.account_balance_ = 0.;
         }
-        else if (pnl_info.eAccountBalance == VALUE_STATE_USE)
+        else if (pnl_info.balance_state_ == VALUE_STATE_USE)
         {   
-            new_pnl.account_balance_ = pnl_info.dAccountBalance;
+            new_pnl.account_balance_ = pnl_info.balance_;
         }
         else
         {
@@ -137,7 +169,7 @@ void RithmicClient::handlePnlInfo(const RApi::PnlInfo &pnl_info)
         }
     } while (!pnl_.compare_exchange_weak(pnl, new_pnl, std::memory_order_release, std::memory_order_relaxed));
 
-    auto position = iter->second.load(std::memory_order_relaxed);
+    auto position = sym->position_.load(std::memory_order_relaxed);
     Position new_position;
     do
     {
@@ -148,68 +180,68 @@ void RithmicClient::handlePnlInfo(const RApi::PnlInfo &pnl_info)
 
         new_position.timestamp_ = timestamp;
 
-        if (pnl_info.eAvgOpenFillPrice == VALUE_STATE_CLEAR)
+        if (pnl_info.avg_price_state_ == VALUE_STATE_CLEAR)
         {
             new_position.average_price_ = 0.;
         }
-        else if (pnl_info.eAvgOpenFillPrice == VALUE_STATE_USE)
+        else if (pnl_info.avg_price_state_ == VALUE_STATE_USE)
         {
-            new_position.average_price_ = pnl_info.dAvgOpenFillPrice;
+            new_position.average_price_ = pnl_info.avg_price_;
         }
         else
         {
             new_position.average_price_ = position.average_price_;
         }
 
-        if (pnl_info.ePosition == VALUE_STATE_CLEAR)
+        if (pnl_info.position_state_ == VALUE_STATE_CLEAR)
         {
             new_position.quantity_ = 0;
         }
-        else if (pnl_info.ePosition == VALUE_STATE_USE)
+        else if (pnl_info.position_state_ == VALUE_STATE_USE)
         {
-            new_position.quantity_ = pnl_info.llPosition;
+            new_position.quantity_ = pnl_info.position_;
         }
         else
         {
             new_position.quantity_ = position.quantity_;
         }
 
-        if (pnl_info.eBuyQty == VALUE_STATE_CLEAR)
+        if (pnl_info.buy_qty_state_ == VALUE_STATE_CLEAR)
         {
             new_position.buy_qty_ = 0;
         }
-        else if (pnl_info.eBuyQty == VALUE_STATE_USE)
+        else if (pnl_info.buy_qty_state_ == VALUE_STATE_USE)
         {
-            new_position.buy_qty_ = pnl_info.llBuyQty;
+            new_position.buy_qty_ = pnl_info.buy_qty_;
         }
         else
         {
             new_position.buy_qty_ = position.buy_qty_;
         }
 
-        if (pnl_info.eSellQty == VALUE_STATE_CLEAR)
+        if (pnl_info.sell_qty_state_ == VALUE_STATE_CLEAR)
         {
             new_position.sell_qty_ = 0;
         }
-        else if (pnl_info.eSellQty == VALUE_STATE_USE)
+        else if (pnl_info.sell_qty_state_ == VALUE_STATE_USE)
         {
-            new_position.sell_qty_ = pnl_info.llSellQty;
+            new_position.sell_qty_ = pnl_info.sell_qty_;
         }
         else
         {
             new_position.sell_qty_ = position.sell_qty_;
         }
 
-    } while (!iter->second.compare_exchange_weak(position, new_position, std::memory_order_release, std::memory_order_relaxed));
-    SPDLOG_TRACE("{} position={}, pnl={}", iter->first, new_position.quantity_, new_pnl.pnl_);
+    } while (!sym->position_.compare_exchange_weak(position, new_position, std::memory_order_release, std::memory_order_relaxed));
+    SPDLOG_TRACE("{} position={}, pnl={}", sym->spec_.symbol_, new_position.quantity_, new_pnl.pnl_);
 }
 
 Position RithmicClient::getPosition(const char *asset) const
 {
-    auto iter = asset_position_.find(asset);
-    if (iter != asset_position_.end())
+    auto iter = symbol_handles_.find(std::string_view(asset));
+    if (iter != symbol_handles_.end())
     {
-        return iter->second.load(std::memory_order_relaxed);
+        return symbols_[iter->second].position_.load(std::memory_order_relaxed);
     }
     return {};
 }
\ No newline at end of file
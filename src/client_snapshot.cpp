@@ -0,0 +1,55 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "stdafx.h"
+#include "client.h"
+
+using namespace zorro;
+
+bool RithmicClient::readCut(Symbol **symbols, uint32_t n, MDTop *tops, Trade *trades, uint32_t &retries) const
+{
+    std::array<uint64_t, MAX_CUT_LEGS> top_seqs;
+    std::array<uint64_t, MAX_CUT_LEGS> trade_seqs;
+    n = std::min(n, MAX_CUT_LEGS);
+    retries = 0;
+    do
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            tops[i] = symbols[i]->top_.load(top_seqs[i]);
+            trades[i] = symbols[i]->last_trade_.load(trade_seqs[i]);
+        }
+
+        // every leg was unchanged from its read until its check, so all of them held at once
+        // between the last read and the first check
+        bool consistent = true;
+        for (uint32_t i = 0; i < n && consistent; ++i)
+        {
+            consistent = symbols[i]->top_.sequence() == top_seqs[i] && symbols[i]->last_trade_.sequence() == trade_seqs[i];
+        }
+        if (consistent)
+        {
+            return true;
+        }
+        YieldProcessor();
+    } while (++retries < MAX_CUT_RETRIES);
+    return false;
+}
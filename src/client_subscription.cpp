@@ -0,0 +1,351 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "stdafx.h"
+#include "client.h"
+#include "config.h"
+#include "utils.h"
+#include "global.h"
+
+using namespace zorro;
+using namespace RApi;
+
+namespace {
+    auto &global = Global::get();
+}
+
+bool RithmicClient::subscribeMD(Symbol &symbol)
+{
+    tsNCharcb exchange{symbol.spec_.exchange_.data(), (int)symbol.spec_.exchange_.length()};
+    tsNCharcb ticker{symbol.spec_.ticker_.data(), (int)symbol.spec_.ticker_.length()};
+
+    symbol.subscribe_flags_ = mdFlags(symbol);
+
+    // a resubscribed symbol waits for fresh quotes and market mode again, the reference data is kept
+    auto ready = symbol.ready_.load(std::memory_order_relaxed);
+    symbol.ready_.store(std::bitset<3>().set(MDReady::RefData, ready.test(MDReady::RefData)), std::memory_order_release);
+    symbol.subscribe_time_ = get_timestamp();
+
+    int i_code;
+    if (!engine_->subscribe(&exchange, &ticker, symbol.subscribe_flags_, &symbol, &i_code))
+    {
+        BrokerError(std::format("REngine::subscribe() err: {}", i_code).c_str());
+        return false;
+    }
+    symbol.subscribed_.store(true, std::memory_order_release);
+    ++n_subscribed_;
+    watch(symbol, symbol.subscribe_time_ + staleThreshold(symbol));
+
+    if (symbol.book_ && !engine_->rebuildBook(&exchange, &ticker, &i_code))
+    {
+        SPDLOG_ERROR("REngine::rebuildBook() {} err: {}", symbol.spec_.symbol_, i_code);
+    }
+    return true;
+}
+
+void RithmicClient::unsubscribeMD(Symbol &symbol)
+{
+    tsNCharcb exchange{symbol.spec_.exchange_.data(), (int)symbol.spec_.exchange_.length()};
+    tsNCharcb ticker{symbol.spec_.ticker_.data(), (int)symbol.spec_.ticker_.length()};
+
+    int i_code;
+    if (!engine_->unsubscribe(&exchange, &ticker, &i_code))
+    {
+        SPDLOG_ERROR("REngine::unsubscribe() {} err: {}", symbol.spec_.symbol_, i_code);
+    }
+    symbol.subscribed_.store(false, std::memory_order_release);
+    // prints are lost until the next subscription, also when it follows right away (resubscribe, stale recovery)
+    symbol.interruptBars();
+    auto elapsed = get_timestamp() - symbol.subscribe_time_;
+    symbol.subscribed_ms_ += elapsed;
+    (symbol.subscribe_flags_ & MD_PRINTS ? symbol.prints_ms_ : symbol.trimmed_ms_) += elapsed;
+    symbol.ref_count_ = 0;
+    --n_subscribed_;
+    SPDLOG_INFO("unsubscribe {}. updates={}", symbol.spec_.symbol_, symbol.updates_.load(std::memory_order_relaxed));
+}
+
+int RithmicClient::mdFlags(const Symbol &symbol) const
+{
+    // quotes are always needed for the ask price, the spread and readiness,
+    // trade prints only when something reads them
+    auto flags = (symbol.subscribe_flags_ & ~MD_PRINTS) | MD_BEST | MD_MARKET_MODE;
+    if (!Config::get().trim_streams_ || global.price_type_.load(std::memory_order_relaxed) == 2 || global.vol_type_ == 2 || global.vol_type_ == 4
+        || recorder_ || symbol.n_bar_builders_.load(std::memory_order_relaxed) || symbol.prints_used_)
+    {
+        flags |= MD_PRINTS;
+    }
+    return flags;
+}
+
+void RithmicClient::resubscribeMD(Symbol &symbol)
+{
+    auto ref_count = symbol.ref_count_;
+    unsubscribeMD(symbol);
+    if (subscribeMD(symbol))
+    {
+        symbol.ref_count_ = ref_count;
+    }
+}
+
+uint32_t RithmicClient::updateStreams()
+{
+    uint32_t n_resubscribed = 0;
+    auto n = n_symbols_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        auto &symbol = symbols_[i];
+        if (!symbol.subscribed_.load(std::memory_order_relaxed) || mdFlags(symbol) == symbol.subscribe_flags_)
+        {
+            continue;
+        }
+
+        // R|API only adds streams to a subscription, a narrower mask needs a fresh one
+        SPDLOG_INFO("resubscribe {} prints={}", symbol.spec_.symbol_, (mdFlags(symbol) & MD_PRINTS) != 0);
+        resubscribeMD(symbol);
+        ++n_resubscribed;
+    }
+    stream_resubscribes_ += n_resubscribed;
+    return n_resubscribed;
+}
+
+void RithmicClient::requirePrints(Symbol &symbol)
+{
+    if (symbol.prints_used_)
+    {
+        return;
+    }
+    symbol.prints_used_ = true;
+    if (symbol.subscribed_.load(std::memory_order_relaxed) && mdFlags(symbol) != symbol.subscribe_flags_)
+    {
+        SPDLOG_INFO("resubscribe {} prints=1, read by a broker command", symbol.spec_.symbol_);
+        resubscribeMD(symbol);
+        ++stream_resubscribes_;
+    }
+}
+
+StreamStatsInfo RithmicClient::streamStats() const
+{
+    StreamStatsInfo info{};
+    auto now = get_timestamp();
+    auto n = n_symbols_.load(std::memory_order_acquire);
+    double saved = 0.;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        auto &symbol = symbols_[i];
+        auto prints_ms = symbol.prints_ms_;
+        auto trimmed_ms = symbol.trimmed_ms_;
+        if (symbol.subscribed_.load(std::memory_order_relaxed))
+        {
+            bool prints = symbol.subscribe_flags_ & MD_PRINTS;
+            (prints ? prints_ms : trimmed_ms) += now - symbol.subscribe_time_;
+            info.trimmed += prints ? 0 : 1;
+        }
+        auto n_prints = symbol.prints_.load(std::memory_order_relaxed);
+        info.prints += (double)n_prints;
+        if (prints_ms)
+        {
+            // estimated from the print rate of the same asset while its prints were subscribed
+            saved += (double)n_prints * trimmed_ms / prints_ms;
+        }
+    }
+    info.saved_prints = saved;
+    info.resubscribes = (int)stream_resubscribes_;
+    return info;
+}
+
+bool RithmicClient::evictLRU()
+{
+    Symbol *lru = nullptr;
+    auto n = n_symbols_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        auto &symbol = symbols_[i];
+        if (!symbol.subscribed_.load(std::memory_order_relaxed) || symbol.position_.load(std::memory_order_relaxed).quantity_ != 0)
+        {
+            // never evict an asset with an open position
+            continue;
+        }
+        if (!lru || symbol.last_used_ < lru->last_used_)
+        {
+            lru = &symbol;
+        }
+    }
+
+    if (!lru)
+    {
+        return false;
+    }
+    SPDLOG_INFO("Max subscriptions reached, evict {}. idle {} ms", lru->spec_.symbol_, get_timestamp() - lru->last_used_);
+    unsubscribeMD(*lru);
+    return true;
+}
+
+Symbol* RithmicClient::acquireSymbol(const char* asset, bool add_ref)
+{
+    auto *sym = getSymbol(asset);
+    if (!sym || !sym->subscribed_.load(std::memory_order_relaxed))
+    {
+        auto max_subscriptions = Config::get().max_subscriptions_;
+        if (max_subscriptions && n_subscribed_ >= max_subscriptions && !evictLRU())
+        {
+            BrokerError(std::format("Failed to subscribe {}. Max {} subscriptions reached", asset, max_subscriptions).c_str());
+            return nullptr;
+        }
+
+        if (!sym)
+        {
+            if (!subscribe(asset))
+            {
+                return nullptr;
+            }
+            sym = getSymbol(asset);
+        }
+        else
+        {
+            SPDLOG_INFO("resubscribe {}", asset);
+            if (!subscribeMD(*sym))
+            {
+                return nullptr;
+            }
+        }
+    }
+
+    if (add_ref || !sym->ref_count_)
+    {
+        ++sym->ref_count_;
+    }
+    sym->last_used_ = get_timestamp();
+    return sym;
+}
+
+int RithmicClient::releaseSymbol(const char* asset)
+{
+    auto *sym = getSymbol(asset);
+    if (!sym || !sym->subscribed_.load(std::memory_order_relaxed))
+    {
+        return -1;
+    }
+
+    if (sym->ref_count_ > 1)
+    {
+        return (int)--sym->ref_count_;
+    }
+    unsubscribeMD(*sym);
+    return 0;
+}
+
+double RithmicClient::updateRate(const Symbol &symbol) const
+{
+    auto ms = symbol.subscribed_ms_;
+    if (symbol.subscribed_.load(std::memory_order_relaxed))
+    {
+        ms += get_timestamp() - symbol.subscribe_time_;
+    }
+    return ms ? symbol.updates_.load(std::memory_order_relaxed) * 1000. / ms : 0.;
+}
+
+int RithmicClient::getSubscriptions(SubscriptionQuery &query) const
+{
+    if (!query.infos || query.max_infos <= 0)
+    {
+        return 0;
+    }
+
+    auto now = get_timestamp();
+    auto n = n_symbols_.load(std::memory_order_acquire);
+    int count = 0;
+    for (uint32_t i = 0; i < n && count < query.max_infos; ++i)
+    {
+        auto &symbol = symbols_[i];
+        auto &info = query.infos[count++];
+        strncpy_s(info.asset, symbol.spec_.symbol_.c_str(), _TRUNCATE);
+        info.refs = (int)symbol.ref_count_;
+        info.subscribed = symbol.subscribed_.load(std::memory_order_relaxed);
+        info.updates = (double)symbol.updates_.load(std::memory_order_relaxed);
+        info.rate = updateRate(symbol);
+        info.idle = (now - symbol.last_used_) / 1000.;
+    }
+    return count;
+}
+
+uint64_t RithmicClient::staleThreshold(const Symbol &symbol) const
+{
+    // a quiet contract is expected to go without updates much longer than an active one
+    static constexpr double QUIET_INTERVALS = 20.;
+    uint64_t threshold = Config::get().stale_timeout_s_ * 1000ull;
+    auto rate = updateRate(symbol);
+    if (rate > 0.)
+    {
+        threshold = std::max(threshold, (uint64_t)(QUIET_INTERVALS * 1000. / rate));
+    }
+    return threshold;
+}
+
+void RithmicClient::watch(Symbol &symbol, uint64_t deadline)
+{
+    if (!Config::get().stale_timeout_s_)
+    {
+        return;
+    }
+    // earlier timers of the symbol are ignored when they fire
+    symbol.watch_deadline_ = deadline;
+    watchdog_.schedule(symbol.handle_, deadline);
+}
+
+void RithmicClient::checkStale()
+{
+    if (!Config::get().stale_timeout_s_)
+    {
+        return;
+    }
+
+    auto now = get_timestamp();
+    watchdog_.advance(now, [this, now](uint32_t handle, uint64_t deadline) {
+        auto &symbol = symbols_[handle];
+        if (deadline != symbol.watch_deadline_ || !symbol.subscribed_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        auto threshold = staleThreshold(symbol);
+        auto last_update = std::max(symbol.last_update_ms_.load(std::memory_order_relaxed), symbol.subscribe_time_);
+        if (!symbol.can_trade_.load(std::memory_order_relaxed) || now < last_update + threshold)
+        {
+            // closed market or data within the expected interval
+            symbol.stale_backoff_ms_ = 0;
+            watch(symbol, std::max(last_update, now) + threshold);
+            return;
+        }
+
+        if (!symbol.stale_.exchange(true, std::memory_order_acq_rel))
+        {
+            ++symbol.stale_count_;
+            SPDLOG_WARN("{} stale, no market data for {} ms. expected within {} ms", symbol.spec_.symbol_, now - last_update, threshold);
+            BrokerError(std::format("{} quotes stale, resubscribing", symbol.spec_.symbol_).c_str());
+        }
+        resubscribeMD(symbol);
+
+        // a symbol that stays stale is resubscribed with an increasing delay
+        static constexpr uint64_t MAX_BACKOFF_MS = 300000;
+        symbol.stale_backoff_ms_ = symbol.stale_backoff_ms_ ? std::min(symbol.stale_backoff_ms_ * 2, MAX_BACKOFF_MS) : threshold;
+        watch(symbol, now + symbol.stale_backoff_ms_);
+    });
+}
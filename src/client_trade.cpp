@@ -34,43 +34,104 @@ namespace
 
 int RithmicClient::TradePrint(RApi::TradeInfo *pInfo, void *pContext, int *aiCode)
 {
+    CallbackTimer timer(ingress_stats_);
     if (pInfo->bPriceFlag)
     {
-        auto sym = symbol(pInfo);
-        auto iter = symbols_.find(sym);
-        if (iter != symbols_.end())
+        auto *sym = resolveSymbol(pInfo, pContext);
+        if (sym)
         {
-            auto &symbol = iter->second;
-            auto trade = symbol.last_trade_.load(std::memory_order_relaxed);
-            Trade new_trade;
-            new_trade.side_ = to_side(*pInfo);
-            new_trade.price_ = pInfo->dPrice;
-            new_trade.qty_ = pInfo->llSize;
-            new_trade.time_ = nanosec(*pInfo);
+            MDEvent event{MDEventType::Trade};
+            event.handle_ = sym->handle_;
+            event.side_ = to_side(*pInfo);
+            event.price_[0] = pInfo->dPrice;
+            event.qty_[0] = pInfo->llSize;
+            event.time_ = nanosec(*pInfo);
             if (pInfo->bVolumeBoughtFlag)
             {
-                new_trade.buy_volume_ = pInfo->llVolumeBought;
-            }
-            else
-            {
-                new_trade.buy_volume_ = trade.buy_volume_;
+                event.flags_ |= mf_BuyVolume;
+                event.volume_[0] = pInfo->llVolumeBought;
             }
             if (pInfo->bVolumeSoldFlag)
             {
-                new_trade.sell_volume_ = pInfo->llVolumeSold;
-            }
-            else
-            {
-                new_trade.sell_volume_ = trade.sell_volume_;
-            }
-            while (!symbol.last_trade_.compare_exchange_weak(trade, new_trade, std::memory_order_release, std::memory_order_relaxed));
-
-            if (global.handle_ && global.price_type_.load(std::memory_order_relaxed) == 2)
-            {
-                PostMessage(global.handle_, WM_APP+1, 0, 0);
+                event.flags_ |= mf_SellVolume;
+                event.volume_[1] = pInfo->llVolumeSold;
             }
+            dispatch(event);
         }
     }
     *aiCode = API_OK;
     return OK;
+}
+
+void RithmicClient::updateSession(Symbol &symbol, const Trade &trade)
+{
+    symbol.session_.update([&trade](SessionStats &stats) {
+        auto daily_volume = trade.buy_volume_ + trade.sell_volume_;
+        if (daily_volume < stats.daily_volume_)
+        {
+            // the exchange reset its daily volume, a new session started
+            stats = SessionStats{};
+        }
+        stats.daily_volume_ = daily_volume;
+        if (!stats.trades_)
+        {
+            stats.start_time_ = trade.time_;
+            stats.high_ = trade.price_;
+            stats.low_ = trade.price_;
+        }
+        else
+        {
+            stats.high_ = std::max(stats.high_, trade.price_);
+            stats.low_ = std::min(stats.low_, trade.price_);
+        }
+        ++stats.trades_;
+        stats.volume_ += trade.qty_;
+        stats.pv_ += trade.price_ * trade.qty_;
+        if (trade.side_ == Side::Buy)
+        {
+            stats.buy_volume_ += trade.qty_;
+        }
+        else if (trade.side_ == Side::Sell)
+        {
+            stats.sell_volume_ += trade.qty_;
+        }
+    });
+}
+
+void RithmicClient::applyTrade(Symbol &symbol, const MDEvent &event)
+{
+    auto trade = symbol.last_trade_.load();
+    Trade new_trade;
+    new_trade.side_ = event.side_;
+    new_trade.price_ = event.price_[0];
+    new_trade.qty_ = event.qty_[0];
+    new_trade.time_ = event.time_;
+    new_trade.buy_volume_ = (event.flags_ & mf_BuyVolume) ? event.volume_[0] : trade.buy_volume_;
+    new_trade.sell_volume_ = (event.flags_ & mf_SellVolume) ? event.volume_[1] : trade.sell_volume_;
+    new_trade.update_seq_ = md_seq_.load(std::memory_order_relaxed);
+    symbol.last_trade_.store(new_trade);
+    symbol.trades_->push(new_trade);
+    symbol.prints_.store(symbol.prints_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    updateSession(symbol, new_trade);
+    recordPublish(symbol, event);
+    if (recorder_)
+    {
+        recorder_->record(symbol.handle_, TickRecorder::Type::T1, nanosec_to_date(new_trade.time_), (float)new_trade.price_);
+    }
+    if (symbol.latency_)
+    {
+        // exchange and local clocks are not synchronized, a negative latency is recorded as 0
+        (*symbol.latency_)[LatencyStage::Exchange].record(event.recv_time_ > event.time_ ? event.recv_time_ - event.time_ : 0);
+    }
+
+    auto n_builders = symbol.n_bar_builders_.load(std::memory_order_acquire);
+    for (auto i = 0u; i < n_builders; ++i)
+    {
+        symbol.bar_builders_[i]->onTrade(new_trade.time_, new_trade.price_, new_trade.qty_);
+    }
+
+    if (global.price_type_.load(std::memory_order_relaxed) == 2)
+    {
+        notifier_.notify(symbol.handle_, global.handle_);
+    }
 }
\ No newline at end of file
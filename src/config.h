@@ -48,6 +48,23 @@ namespace zorro {
     struct Config {
         uint8_t log_level_ = spdlog::level::info;
         std::string rithmic_config_path_ = "rithmic.bin";
+        uint32_t notify_interval_ms_ = 0;
+        uint8_t market_depth_ = 0;
+        uint8_t daily_stats_ = 0;
+        uint8_t trim_streams_ = 1;
+        uint32_t stale_timeout_s_ = 30;
+        uint32_t order_retention_min_ = 60;
+        uint8_t async_orders_ = 0;
+        std::string provisional_ids_ = "Data\\rithmic_provisional.csv";
+        std::string subscribe_list_;
+        uint32_t wait_spin_count_ = 2000;
+        uint32_t wait_yield_count_ = 100;
+        uint32_t wait_block_ms_ = 1;
+        uint8_t callback_queue_ = 0;
+        std::string record_path_;
+        uint32_t max_subscriptions_ = 0;
+        std::string ref_data_cache_ = "Data\\rithmic_refdata.csv";
+        uint32_t ref_data_expiry_h_ = 24;
 
         static Config& get()
         {
@@ -87,6 +104,23 @@ namespace zorro {
 
                 getConfig(line, ConfigFound::cf_LogLevel, "RithmicLogLevel", log_level_);
                 getConfig(line, ConfigFound::cf_RithmicConfigPath, "RithmicConfigPath", rithmic_config_path_);
+                getConfig(line, ConfigFound::cf_NotifyInterval, "RithmicNotifyInterval", notify_interval_ms_);
+                getConfig(line, ConfigFound::cf_MarketDepth, "RithmicMarketDepth", market_depth_);
+                getConfig(line, ConfigFound::cf_SubscribeList, "RithmicSubscribe", subscribe_list_);
+                getConfig(line, ConfigFound::cf_WaitSpinCount, "RithmicWaitSpin", wait_spin_count_);
+                getConfig(line, ConfigFound::cf_WaitYieldCount, "RithmicWaitYield", wait_yield_count_);
+                getConfig(line, ConfigFound::cf_WaitBlockMs, "RithmicWaitBlock", wait_block_ms_);
+                getConfig(line, ConfigFound::cf_CallbackQueue, "RithmicCallbackQueue", callback_queue_);
+                getConfig(line, ConfigFound::cf_RecordPath, "RithmicRecordPath", record_path_);
+                getConfig(line, ConfigFound::cf_MaxSubscriptions, "RithmicMaxSubscriptions", max_subscriptions_);
+                getConfig(line, ConfigFound::cf_RefDataCache, "RithmicRefDataCache", ref_data_cache_);
+                getConfig(line, ConfigFound::cf_RefDataExpiry, "RithmicRefDataExpiry", ref_data_expiry_h_);
+                getConfig(line, ConfigFound::cf_DailyStats, "RithmicDailyStats", daily_stats_);
+                getConfig(line, ConfigFound::cf_TrimStreams, "RithmicTrimStreams", trim_streams_);
+                getConfig(line, ConfigFound::cf_StaleTimeout, "RithmicStaleTimeout", stale_timeout_s_);
+                getConfig(line, ConfigFound::cf_OrderRetention, "RithmicOrderRetention", order_retention_min_);
+                getConfig(line, ConfigFound::cf_AsyncOrders, "RithmicAsyncOrders", async_orders_);
+                getConfig(line, ConfigFound::cf_ProvisionalIds, "RithmicProvisionalIds", provisional_ids_);
             }
             config.close();
             return configFound_.all();
@@ -137,6 +171,23 @@ namespace zorro {
         {
             cf_LogLevel,
             cf_RithmicConfigPath,
+            cf_NotifyInterval,
+            cf_MarketDepth,
+            cf_SubscribeList,
+            cf_WaitSpinCount,
+            cf_WaitYieldCount,
+            cf_WaitBlockMs,
+            cf_CallbackQueue,
+            cf_RecordPath,
+            cf_MaxSubscriptions,
+            cf_RefDataCache,
+            cf_RefDataExpiry,
+            cf_DailyStats,
+            cf_TrimStreams,
+            cf_StaleTimeout,
+            cf_OrderRetention,
+            cf_AsyncOrders,
+            cf_ProvisionalIds,
             __count__,  // for internal use only
         };
         std::bitset<ConfigFound::__count__> configFound_ = 0;
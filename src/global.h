@@ -23,6 +23,7 @@
 
 #include <string>
 #include "pnl.h"
+#include "config.h"
 #include <unordered_set>
 
 namespace zorro {
@@ -53,6 +54,9 @@ struct Global
     double multiplier_ = 1.0;
     std::atomic<int32_t> price_type_{0};
     int32_t vol_type_ = 0;
+    bool market_depth_ = false;
+    bool daily_stats_ = false;
+    bool async_orders_ = false;
 
     std::unordered_set<std::string> asset_no_data_;
 
@@ -71,6 +75,9 @@ struct Global
         multiplier_ = 1.0;
         asset_no_data_.clear();
         price_type_.store(0, std::memory_order_release);
+        market_depth_ = Config::get().market_depth_;
+        daily_stats_ = Config::get().daily_stats_;
+        async_orders_ = Config::get().async_orders_;
     }
 
 private:
@@ -0,0 +1,160 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "spsc_queue.h"
+
+namespace zorro {
+
+enum class Side : uint8_t;
+
+enum class MDEventType : uint8_t
+{
+    Top,
+    Trade,
+    MarketMode,
+    Book,
+    DailyStat,
+};
+
+// MDEvent::flags_
+enum MDFlag : uint8_t
+{
+    mf_BidPrice = 1,        // Top
+    mf_BidSize = 2,
+    mf_AskPrice = 4,
+    mf_AskSize = 8,
+    mf_BuyVolume = 1,       // Trade
+    mf_SellVolume = 2,
+    mf_Open = 1,            // MarketMode
+    mf_BookBegin = 1,       // Book
+    mf_BookEnd = 2,
+    mf_BookClear = 4,
+    mf_BookLevel = 8,
+    mf_DailyOpen = 1,       // DailyStat, one field per event
+    mf_DailyHigh = 2,
+    mf_DailyLow = 4,
+    mf_DailyClose = 8,
+    mf_DailySettlement = 16,
+    mf_DailyOpenInterest = 32,
+};
+
+/**
+ * @brief Market data update copied out of a RApi callback.
+ *
+ * Top: price_/qty_ hold bid [0] and ask [1].
+ * Trade: price_[0], qty_[0], time_ and the daily bought/sold volumes in volume_.
+ * Book: one level of side_ in price_[0]/qty_[0].
+ * DailyStat: the price in price_[0], NaN when cleared, or the open interest in qty_[0].
+ */
+struct MDEvent
+{
+    MDEventType type_;
+    uint8_t flags_ = 0;
+    Side side_;
+    uint32_t handle_;
+    uint64_t time_ = 0;
+    uint64_t recv_time_ = 0;    // ns, when the callback received the update
+    double price_[2];
+    int64_t qty_[2];
+    uint64_t volume_[2];
+};
+
+struct PnlEvent
+{
+    uint32_t handle_;
+    uint64_t time_;
+    int open_pnl_state_;
+    int closed_pnl_state_;
+    int balance_state_;
+    int avg_price_state_;
+    int position_state_;
+    int buy_qty_state_;
+    int sell_qty_state_;
+    double open_pnl_;
+    double closed_pnl_;
+    double balance_;
+    double avg_price_;
+    int64_t position_;
+    int64_t buy_qty_;
+    int64_t sell_qty_;
+};
+
+// engine requests deferred from a callback to the ingress thread. R|API order numbers are
+// decimal and kept as OrderState::order_num_, the number is formatted again when the cancel is sent.
+struct CancelEvent
+{
+    uint32_t order_num_;
+};
+
+struct IngressStats
+{
+    std::atomic<uint64_t> md_events_{0};
+    std::atomic<uint64_t> pnl_events_{0};
+    std::atomic<uint64_t> cancels_{0};
+    std::atomic<uint64_t> stalls_{0};           // pushes that found their queue full
+    std::atomic<uint64_t> inline_events_{0};    // applied on the callback thread because the ingress thread was not running
+    std::atomic<uint64_t> callbacks_{0};        // market data callbacks
+    std::atomic<uint64_t> callback_ns_{0};      // total time spent in market data callbacks
+    std::atomic<uint64_t> max_callback_ns_{0};
+};
+
+struct OrderReportStats
+{
+    std::atomic<uint64_t> callbacks_{0};        // order report callbacks for Zorro orders
+    std::atomic<uint64_t> callback_ns_{0};      // total time spent applying them
+    std::atomic<uint64_t> max_callback_ns_{0};
+    std::atomic<uint64_t> entries_[2]{};        // order entries, [0] blocking, [1] asynchronous
+    std::atomic<uint64_t> entry_ns_[2]{};       // time order entry held the Zorro thread
+};
+
+/**
+ * @brief Measures how long a callback holds the RApi thread.
+ */
+template<typename StatsT>
+class CallbackTimer
+{
+    StatsT &stats_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit CallbackTimer(StatsT &stats) noexcept : stats_(stats), start_(std::chrono::steady_clock::now()) {}
+    ~CallbackTimer()
+    {
+        auto ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+        stats_.callbacks_.fetch_add(1, std::memory_order_relaxed);
+        stats_.callback_ns_.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > stats_.max_callback_ns_.load(std::memory_order_relaxed))
+        {
+            stats_.max_callback_ns_.store(ns, std::memory_order_relaxed);
+        }
+    }
+};
+
+using MDQueue = SpscQueue<MDEvent, 65536>;
+using PnlQueue = SpscQueue<PnlEvent, 1024>;
+using CancelQueue = SpscQueue<CancelEvent, 256>;
+
+}   // namespace zorro
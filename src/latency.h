@@ -0,0 +1,143 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace zorro {
+
+/**
+ * @brief Lock-free log-linear latency histogram, HDR style.
+ *
+ * Every power of 2 range is split into 16 linear sub-buckets, a recorded value is off by at most
+ * 1/16 of itself. Values are nanoseconds up to 2^40 (~18 minutes), larger values land in the last
+ * bucket. Recording is a relaxed fetch_add, any thread may record or read.
+ */
+class LatencyHistogram
+{
+    static constexpr uint32_t SUB_BITS = 4;
+    static constexpr uint32_t SUB_COUNT = 1u << SUB_BITS;
+    static constexpr uint32_t MAX_BITS = 40;
+    static constexpr uint32_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+
+    static uint32_t index(uint64_t value) noexcept
+    {
+        if (value < SUB_COUNT)
+        {
+            return (uint32_t)value;
+        }
+        auto shift = (uint32_t)std::bit_width(value) - 1 - SUB_BITS;
+        auto i = (shift + 1) * SUB_COUNT + (uint32_t)((value >> shift) & (SUB_COUNT - 1));
+        return i < BUCKETS ? i : BUCKETS - 1;
+    }
+
+    // upper bound of the values in bucket i
+    static uint64_t value(uint32_t i) noexcept
+    {
+        if (i < SUB_COUNT)
+        {
+            return i;
+        }
+        auto shift = i / SUB_COUNT - 1;
+        return ((uint64_t)(SUB_COUNT + i % SUB_COUNT + 1) << shift) - 1;
+    }
+
+public:
+    void record(uint64_t ns) noexcept
+    {
+        buckets_[index(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > max_.load(std::memory_order_relaxed))
+        {
+            max_.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+    uint64_t mean() const noexcept
+    {
+        auto n = count();
+        return n ? sum_.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    /**
+     * @param q quantile in [0, 1]
+     * @return upper bound of the bucket the quantile falls in, ns
+     */
+    uint64_t percentile(double q) const noexcept
+    {
+        auto n = count();
+        if (!n)
+        {
+            return 0;
+        }
+        auto rank = (uint64_t)(q * (double)n + 0.5);
+        rank = rank ? rank : 1;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKETS; ++i)
+        {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                return std::min(value(i), max());
+            }
+        }
+        return max();
+    }
+};
+
+enum class LatencyStage : uint8_t
+{
+    Exchange,   // exchange source time -> callback receipt, trades only
+    Publish,    // callback receipt -> symbol state published
+    Read,       // first unread publish -> read by BrokerAsset
+    __count__,  // number of LatencyStage, internal use only
+};
+
+inline const char* to_string(LatencyStage stage)
+{
+    static constexpr std::array<const char*, 3> stage_str = {"Exchange", "Publish", "Read"};
+    static_assert(stage_str.size() == (size_t)LatencyStage::__count__, "Invalid LatencyStage");
+    return stage_str[(uint8_t)stage];
+}
+
+struct LatencyStats
+{
+    std::array<LatencyHistogram, (size_t)LatencyStage::__count__> stages_;
+    std::atomic<uint64_t> unread_since_{0};    // ns, first publish not yet read by Zorro
+
+    LatencyHistogram& operator[](LatencyStage stage) noexcept { return stages_[(uint8_t)stage]; }
+    const LatencyHistogram& operator[](LatencyStage stage) const noexcept { return stages_[(uint8_t)stage]; }
+};
+
+}   // namespace zorro
@@ -0,0 +1,107 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include "utils.h"
+
+namespace zorro {
+
+/**
+ * @brief Conflates market data updates into Zorro wakeups.
+ *
+ * Every update marks its symbol dirty, but at most one WM_APP+1 message is outstanding at a time.
+ * The pending flag is cleared when Zorro consumes the wakeup by calling BrokerAsset. An optional
+ * minimum interval further throttles the wakeups, an update suppressed by the interval is picked
+ * up by Zorro's regular price polling.
+ */
+template<uint32_t N>
+class ZorroNotifier
+{
+    std::array<std::atomic<uint64_t>, (N + 63) / 64> dirty_{};
+    std::atomic_bool pending_{false};
+    std::atomic<uint64_t> last_post_time_{0};
+    std::atomic<uint64_t> updates_{0};
+    std::atomic<uint64_t> wakeups_{0};
+    uint64_t min_interval_ms_ = 0;
+
+public:
+    void setMinInterval(uint64_t min_interval_ms) noexcept { min_interval_ms_ = min_interval_ms; }
+
+    /**
+     * @brief Called from the market data callback after the symbol state has been published.
+     */
+    void notify(uint32_t handle, HWND hwnd) noexcept
+    {
+        updates_.fetch_add(1, std::memory_order_relaxed);
+        dirty_[handle >> 6].fetch_or(1ull << (handle & 63), std::memory_order_release);
+
+        if (!hwnd || pending_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        uint64_t now = 0;
+        if (min_interval_ms_)
+        {
+            now = get_timestamp();
+            if (now - last_post_time_.load(std::memory_order_relaxed) < min_interval_ms_)
+            {
+                return;
+            }
+        }
+
+        if (pending_.exchange(true, std::memory_order_acq_rel))
+        {
+            return;
+        }
+
+        last_post_time_.store(now, std::memory_order_relaxed);
+        if (PostMessage(hwnd, WM_APP+1, 0, 0))
+        {
+            wakeups_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            pending_.store(false, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Called by the Zorro thread when it reads a symbol.
+     * @return true if the symbol was updated since it was last consumed.
+     */
+    bool consume(uint32_t handle) noexcept
+    {
+        pending_.store(false, std::memory_order_release);
+        auto mask = 1ull << (handle & 63);
+        return dirty_[handle >> 6].fetch_and(~mask, std::memory_order_acq_rel) & mask;
+    }
+
+    uint64_t updates() const noexcept { return updates_.load(std::memory_order_relaxed); }
+    uint64_t wakeups() const noexcept { return wakeups_.load(std::memory_order_relaxed); }
+};
+
+}   // namespace zorro
@@ -21,8 +21,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdint>
-#include <string>
+#include <cstring>
+#include <string_view>
+#include "seqlock.h"
 
 namespace zorro {
 
@@ -54,46 +59,196 @@ inline const char* to_string(Duration duration)
     return s_duration[static_cast<uint8_t>(duration)];
 }
 
-struct Order
+enum class OrderType : uint8_t
 {
-    std::string symbol_;
-    std::string exchange_;
-    std::string ticker_;
-    std::string exch_ord_id_;
-    std::string ticker_plant_exch_ord_id_;
-
-    std::string str_order_num_;
-    std::string original_order_num_;
-    std::string initial_sequence_number_;
-    std::string current_sequence_number_;
-    std::string omni_bus_account_;
-    std::string tag_;
-    std::string text_;
-    std::string user_msg_;
-
-    tsNCharcb duration_; 
-    tsNCharcb order_type_;
-    tsNCharcb original_order_type_;
-    tsNCharcb trade_route_;
-    tsNCharcb status_;
-    tsNCharcb completion_reason_;
+    Unknown,
+    Limit,
+    Market,
+    StopLimit,
+    StopMarket,
+    Other,
+    __count__,  // number of OrderType, internal use only
+};
 
+inline const char* to_string(OrderType type)
+{
+    static constexpr const char* s_order_type[] = {
+        "Unknown",
+        "Limit",
+        "Market",
+        "StopLimit",
+        "StopMarket",
+        "Other",
+    };
+    static_assert(sizeof(s_order_type) / sizeof(s_order_type[0]) == (size_t)OrderType::__count__, "OrderType string array size mismatch");
+    return s_order_type[static_cast<uint8_t>(type)];
+}
+
+enum class OrderStatus : uint8_t
+{
+    Unknown,
+    Open,
+    Complete,   // a completion reason was reported
+    Other,      // pending states before the order is open
+    __count__,  // number of OrderStatus, internal use only
+};
+
+inline const char* to_string(OrderStatus status)
+{
+    static constexpr const char* s_order_status[] = {
+        "Unknown",
+        "Open",
+        "Complete",
+        "Other",
+    };
+    static_assert(sizeof(s_order_status) / sizeof(s_order_status[0]) == (size_t)OrderStatus::__count__, "OrderStatus string array size mismatch");
+    return s_order_status[static_cast<uint8_t>(status)];
+}
+
+enum class CompletionReason : uint8_t
+{
+    None,
+    Fill,
+    PartialFillBeforeCancel,
+    Cancel,
+    Reject,
+    Failure,
+    Other,
+    __count__,  // number of CompletionReason, internal use only
+};
+
+inline const char* to_string(CompletionReason reason)
+{
+    static constexpr const char* s_completion_reason[] = {
+        "None",
+        "Fill",
+        "PartialFillBeforeCancel",
+        "Cancel",
+        "Reject",
+        "Failure",
+        "Other",
+    };
+    static_assert(sizeof(s_completion_reason) / sizeof(s_completion_reason[0]) == (size_t)CompletionReason::__count__, "CompletionReason string array size mismatch");
+    return s_completion_reason[static_cast<uint8_t>(reason)];
+}
+
+/**
+ * @brief Hot part of an order, published through Order::state_.
+ *
+ * Written in place by the thread handling the order reports, read by BrokerBuy2 and BrokerTrade.
+ * R|API strings are converted to enums when the report arrives.
+ */
+struct OrderState
+{
     double price_ = NAN;
-    double trigger_price_ = NAN;
     double avg_fill_price_ = NAN;
-    double last_filled_price_ = NAN;
-
     uint64_t qty_ = 0;
     uint64_t exec_qty_ = 0;
+    uint32_t order_num_ = 0;
+    Side side_ = Side::Buy;
+    OrderType order_type_ = OrderType::Unknown;
+    Duration duration_ = Duration::Day;
+    OrderStatus status_ = OrderStatus::Unknown;
+    CompletionReason completion_reason_ = CompletionReason::None;
+    bool cancelled_ = false;
+
+    bool completed() const noexcept { return cancelled_ || completion_reason_ != CompletionReason::None; }
+};
+
+/**
+ * @brief Cold part of an order, published through Order::detail_.
+ */
+struct OrderDetail
+{
+    double trigger_price_ = NAN;
+    double last_filled_price_ = NAN;
     uint64_t last_filled_qty_ = 0;
     uint64_t last_update_time_ = 0;
+    OrderType original_order_type_ = OrderType::Unknown;
+    char text_[96] = {};
+};
+
+// Order::requests_, requests whose completion a thread is waiting for
+enum OrderRequest : uint8_t
+{
+    or_Send = 1,
+    or_Cancel = 2,
+    or_Replay = 4,
+};
+
+// the order state seqlock, handle, pending cancel flag and requests share the first cache line of an order
+static_assert(sizeof(SeqLock<OrderState>) + sizeof(uint32_t) + 2 <= 64, "OrderState doesn't fit in a cache line");
+
+/**
+ * @brief Order record, lives in the OrderPool at a fixed address.
+ *
+ * The identifiers are stored inline. symbol_, exchange_, ticker_, tag_ and client_order_id_ are set
+ * before the order is handed to RApi, the others are copied from reports by the RApi thread.
+ */
+struct alignas(64) Order
+{
+    SeqLock<OrderState> state_;
+    std::atomic<uint32_t> handle_{0};       // generation tagged handle, 0 while the slot is unused
+    std::atomic_bool pending_cancel_{false};
+    std::atomic<uint8_t> requests_{0};      // OrderRequest flags, set by the requesting thread, cleared by reports
+
+    SeqLock<OrderDetail> detail_;
     uint64_t client_order_id_ = 0;
-    int32_t index_ = -1;
-    uint32_t order_num_ = 0;
-    Side side_ = Side::Buy;
+    std::atomic<uint64_t> last_access_ms_{0};   // last use by any thread, read by retireOrders
+    uint32_t generation_ = 0;               // of the last handle, owned by OrderPool
+    std::atomic<uint32_t> pins_{0};         // report callbacks holding the record, see OrderPool::pin
+    uint32_t trade_id_ = 0;                 // id known to Zorro, the order number or a provisional id
 
-    bool pending_cancel_ = false;
-    bool cancelled_ = false;
+    char symbol_[48] = {};
+    char exchange_[16] = {};
+    char ticker_[32] = {};
+    char tag_[48] = {};                     // ZORRO_<client order id>[_<provisional id>]
+    char trade_route_[16] = {};
+    char exch_ord_id_[32] = {};
+    char ticker_plant_exch_ord_id_[32] = {};
+    char original_order_num_[16] = {};
+    char initial_sequence_number_[16] = {};
+    char current_sequence_number_[16] = {};
+    char omni_bus_account_[32] = {};
+
+    /**
+     * @brief Clear a recycled record.
+     */
+    void reset() noexcept
+    {
+        state_.store(OrderState{});
+        pending_cancel_.store(false, std::memory_order_relaxed);
+        requests_.store(0, std::memory_order_relaxed);
+        detail_.store(OrderDetail{});
+        client_order_id_ = 0;
+        last_access_ms_.store(0, std::memory_order_relaxed);
+        trade_id_ = 0;
+        symbol_[0] = 0;
+        exchange_[0] = 0;
+        ticker_[0] = 0;
+        tag_[0] = 0;
+        trade_route_[0] = 0;
+        exch_ord_id_[0] = 0;
+        ticker_plant_exch_ord_id_[0] = 0;
+        original_order_num_[0] = 0;
+        initial_sequence_number_[0] = 0;
+        current_sequence_number_[0] = 0;
+        omni_bus_account_[0] = 0;
+    }
 };
 
+/**
+ * @brief Copy a string into a fixed size, null terminated buffer. Truncates.
+ */
+template<size_t N>
+inline void copyId(char (&dst)[N], std::string_view src) noexcept
+{
+    auto len = std::min(src.size(), N - 1);
+    if (len)
+    {
+        std::memcpy(dst, src.data(), len);
+    }
+    dst[len] = 0;
+}
+
 }
\ No newline at end of file
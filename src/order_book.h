@@ -0,0 +1,312 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "order.h"
+
+typedef double DATE;
+#include <include/trading.h>
+
+namespace zorro {
+
+/**
+ * @brief Price level book for one symbol.
+ *
+ * Sizes are kept in two contiguous arrays indexed by the tick offset from base_tick_, so an update
+ * is a single store and a snapshot is a linear scan over the occupied range. When a price falls
+ * outside of the window, the window is re-centered on it and levels shifted out are dropped.
+ * Single writer (the RApi callback thread), readers copy the book under a sequence number and
+ * retry a bounded number of times if they overlap an update, after that the snapshot fails.
+ */
+class OrderBook
+{
+public:
+    static constexpr int32_t LEVELS = 2048;
+
+private:
+    static constexpr int32_t MAX_READ_RETRY = 16;
+
+    const double tick_size_;
+    std::atomic<uint64_t> seq_{0};
+    std::atomic<int64_t> base_tick_{0};
+    std::atomic<int32_t> lo_{LEVELS};   // lowest occupied index
+    std::atomic<int32_t> hi_{-1};       // highest occupied index
+    std::array<std::atomic<int64_t>, LEVELS> bid_size_{};
+    std::array<std::atomic<int64_t>, LEVELS> ask_size_{};
+
+    // writer only
+    bool empty_ = true;
+    bool batch_ = false;    // between a BEGIN and its END
+
+public:
+    explicit OrderBook(double tick_size) noexcept : tick_size_(tick_size) {}
+
+    double tickSize() const noexcept { return tick_size_; }
+
+    /**
+     * @brief Number of price indices a snapshot scans, from the lowest to the highest occupied level.
+     */
+    int32_t span() const noexcept { return std::max(hi_.load(std::memory_order_relaxed) - lo_.load(std::memory_order_relaxed) + 1, 0); }
+
+    /**
+     * @brief Start a batch of updates, readers will not see a partially applied batch.
+     * Batches don't nest. A BEGIN whose END was lost is continued by the next one, whose END closes both.
+     */
+    void begin() noexcept
+    {
+        if (!batch_)
+        {
+            open();
+            batch_ = true;
+        }
+    }
+
+    void end() noexcept
+    {
+        if (batch_)
+        {
+            batch_ = false;
+            close();
+        }
+    }
+
+    void update(Side side, double price, int64_t size) noexcept
+    {
+        if (std::isnan(price))
+        {
+            return;
+        }
+
+        auto tick = std::llround(price / tick_size_);
+        Write write(*this);
+        if (empty_)
+        {
+            base_tick_.store(tick - LEVELS / 2, std::memory_order_relaxed);
+            empty_ = false;
+        }
+
+        auto index = tick - base_tick_.load(std::memory_order_relaxed);
+        if (index < 0 || index >= LEVELS)
+        {
+            if (size <= 0)
+            {
+                return;
+            }
+            recenter(tick);
+            index = tick - base_tick_.load(std::memory_order_relaxed);
+        }
+
+        levels(side)[index].store(std::max<int64_t>(size, 0), std::memory_order_relaxed);
+        auto lo = lo_.load(std::memory_order_relaxed);
+        auto hi = hi_.load(std::memory_order_relaxed);
+        if (size > 0)
+        {
+            lo_.store(std::min(lo, (int32_t)index), std::memory_order_relaxed);
+            hi_.store(std::max(hi, (int32_t)index), std::memory_order_relaxed);
+        }
+        else if (index == lo || index == hi)
+        {
+            // an outer level was removed, move the bound inward to the next occupied level
+            while (lo <= hi && !occupied(lo))
+            {
+                ++lo;
+            }
+            while (hi >= lo && !occupied(hi))
+            {
+                --hi;
+            }
+            if (lo > hi)
+            {
+                lo = LEVELS;
+                hi = -1;
+            }
+            lo_.store(lo, std::memory_order_relaxed);
+            hi_.store(hi, std::memory_order_relaxed);
+        }
+    }
+
+    void clear(Side side) noexcept
+    {
+        Write write(*this);
+        auto &sizes = levels(side);
+        for (auto &size : sizes)
+        {
+            size.store(0, std::memory_order_relaxed);
+        }
+        updateRange();
+    }
+
+    /**
+     * @brief Copy the book into a Zorro T2 list, bid prices are negative. Levels are copied outward from
+     * the touch, alternating between the sides, so a short list drops the far levels.
+     * @return number of T2 entries filled, -1 if every attempt overlapped an update
+     */
+    int snapshot(T2 *out, int max_quotes, DATE time) const noexcept
+    {
+        for (auto attempt = 0; attempt < MAX_READ_RETRY; ++attempt)
+        {
+            auto seq = seq_.load(std::memory_order_acquire);
+            int n = 0;
+            auto base = base_tick_.load(std::memory_order_relaxed);
+            auto lo = std::max(lo_.load(std::memory_order_relaxed), 0);
+            auto hi = std::min(hi_.load(std::memory_order_relaxed), LEVELS - 1);
+
+            // best bid downward, best ask upward
+            auto bid = hi;
+            auto ask = lo;
+            auto nextBid = [&]()
+            {
+                while (bid >= lo && bid_size_[bid].load(std::memory_order_relaxed) <= 0)
+                {
+                    --bid;
+                }
+            };
+            auto nextAsk = [&]()
+            {
+                while (ask <= hi && ask_size_[ask].load(std::memory_order_relaxed) <= 0)
+                {
+                    ++ask;
+                }
+            };
+            nextBid();
+            nextAsk();
+            while (n < max_quotes && (bid >= lo || ask <= hi))
+            {
+                if (bid >= lo)
+                {
+                    out[n++] = T2{time, -(float)((base + bid) * tick_size_), (float)bid_size_[bid].load(std::memory_order_relaxed)};
+                    --bid;
+                    nextBid();
+                }
+                if (ask <= hi && n < max_quotes)
+                {
+                    out[n++] = T2{time, (float)((base + ask) * tick_size_), (float)ask_size_[ask].load(std::memory_order_relaxed)};
+                    ++ask;
+                    nextAsk();
+                }
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!(seq & 1) && seq_.load(std::memory_order_relaxed) == seq)
+            {
+                return n;
+            }
+        }
+        return -1;
+    }
+
+private:
+    // a single update or clear, part of the open batch if there is one
+    class Write
+    {
+        OrderBook &book_;
+        const bool own_;
+
+    public:
+        explicit Write(OrderBook &book) noexcept : book_(book), own_(!book.batch_)
+        {
+            if (own_)
+            {
+                book_.open();
+            }
+        }
+        ~Write()
+        {
+            if (own_)
+            {
+                book_.close();
+            }
+        }
+    };
+
+    void open() noexcept
+    {
+        seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void close() noexcept
+    {
+        seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool occupied(int32_t i) const noexcept
+    {
+        return bid_size_[i].load(std::memory_order_relaxed) > 0 || ask_size_[i].load(std::memory_order_relaxed) > 0;
+    }
+
+    std::array<std::atomic<int64_t>, LEVELS>& levels(Side side) noexcept
+    {
+        return side == Side::Buy ? bid_size_ : ask_size_;
+    }
+
+    void recenter(int64_t tick) noexcept
+    {
+        auto old_base = base_tick_.load(std::memory_order_relaxed);
+        auto new_base = tick - LEVELS / 2;
+        auto shift = new_base - old_base;
+        for (auto *sizes : {&bid_size_, &ask_size_})
+        {
+            if (shift > 0)
+            {
+                for (int64_t i = 0; i < LEVELS; ++i)
+                {
+                    auto src = i + shift;
+                    (*sizes)[i].store(src < LEVELS ? (*sizes)[src].load(std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+                }
+            }
+            else
+            {
+                for (int64_t i = LEVELS - 1; i >= 0; --i)
+                {
+                    auto src = i + shift;
+                    (*sizes)[i].store(src >= 0 ? (*sizes)[src].load(std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+                }
+            }
+        }
+        base_tick_.store(new_base, std::memory_order_relaxed);
+        updateRange();
+    }
+
+    void updateRange() noexcept
+    {
+        int32_t lo = LEVELS;
+        int32_t hi = -1;
+        for (int32_t i = 0; i < LEVELS; ++i)
+        {
+            if (occupied(i))
+            {
+                lo = std::min(lo, i);
+                hi = i;
+            }
+        }
+        lo_.store(lo, std::memory_order_relaxed);
+        hi_.store(hi, std::memory_order_relaxed);
+    }
+};
+
+}   // namespace zorro
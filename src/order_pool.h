@@ -0,0 +1,281 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include "order.h"
+
+namespace zorro {
+
+/**
+ * @brief Preallocated order records addressed by a generation tagged handle.
+ *
+ * Records are allocated a chunk at a time when an index in the chunk is first used and never move,
+ * so report callbacks update them in place. The handle is passed to RApi as the order context,
+ * it packs the slot index into the low INDEX_BITS and the slot generation into the high bits.
+ * get() only returns a record whose current handle matches, a stale or foreign context yields nullptr.
+ * Generations start at 1 so a valid handle is never 0 (a null context).
+ *
+ * Released slots are reused oldest first with the next generation, but only once REUSE_DELAY slots are
+ * waiting, or when every index is taken. The handle has room for only MAX_GENERATION generations, a slot
+ * released right after allocation (a failed send, a timed out replay) would otherwise come straight back
+ * and wrap them within a few thousand orders, letting a late report match a new order. With the delay a
+ * handle repeats after REUSE_DELAY * MAX_GENERATION allocations at the earliest. Memory therefore follows
+ * the peak number of live orders plus REUSE_DELAY, not the number of orders sent in the session.
+ *
+ * A report callback can resolve a handle right before the Zorro thread releases the order, so callbacks
+ * hold the record through pin() rather than get(). A pinned slot is skipped by reuse() and its record is
+ * not reset until the callback is done with it. get() is for the thread that releases orders.
+ */
+class OrderPool
+{
+public:
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t CHUNK_SIZE = 1024;
+    static constexpr uint32_t MAX_CHUNKS = (INDEX_MASK + 1) / CHUNK_SIZE;
+    static constexpr uint32_t MAX_GENERATION = (1u << (32 - INDEX_BITS)) - 1;
+    static constexpr uint32_t REUSE_DELAY = 1024;
+
+private:
+    std::array<std::atomic<Order*>, MAX_CHUNKS> chunks_{};
+    std::atomic<uint32_t> next_index_{0};
+    const uint32_t capacity_;
+
+    // released slot indices. Allocation is rare compared to order reports, which never take the lock.
+    std::mutex free_mutex_;
+    std::deque<uint32_t> free_;     // FIFO
+    std::atomic<uint32_t> live_{0};
+    std::atomic<uint64_t> recycled_{0};
+
+public:
+    explicit OrderPool(uint32_t capacity) noexcept : capacity_(std::min(capacity, INDEX_MASK + 1)) {}
+    ~OrderPool()
+    {
+        for (auto &chunk : chunks_)
+        {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    /**
+     * @brief A record held by a report callback, converts to Order* and unpins when it goes out of scope.
+     */
+    class Pin
+    {
+        Order *order_ = nullptr;
+
+    public:
+        Pin() noexcept = default;
+        explicit Pin(Order *order) noexcept : order_(order) {}
+        Pin(Pin &&other) noexcept : order_(std::exchange(other.order_, nullptr)) {}
+        Pin& operator=(Pin&&) = delete;
+        ~Pin()
+        {
+            if (order_)
+            {
+                order_->pins_.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        operator Order*() const noexcept { return order_; }
+        Order* operator->() const noexcept { return order_; }
+    };
+
+    static uint32_t index(uint32_t handle) noexcept { return handle & INDEX_MASK; }
+    static void* context(uint32_t handle) noexcept { return reinterpret_cast<void*>(static_cast<uintptr_t>(handle)); }
+
+    /**
+     * @brief Take the next free record. Returns nullptr when the pool is exhausted.
+     */
+    Order* allocate()
+    {
+        {
+            std::lock_guard lock(free_mutex_);
+            if (free_.size() > REUSE_DELAY)
+            {
+                if (auto *order = reuse())
+                {
+                    return order;
+                }
+            }
+        }
+
+        auto idx = next_index_.fetch_add(1, std::memory_order_relaxed);
+        if (idx >= capacity_)
+        {
+            next_index_.store(capacity_, std::memory_order_relaxed);
+            // out of fresh indices, reuse whatever was released
+            std::lock_guard lock(free_mutex_);
+            return free_.empty() ? nullptr : reuse();
+        }
+
+        auto &chunk = chunks_[idx / CHUNK_SIZE];
+        auto *records = chunk.load(std::memory_order_acquire);
+        if (!records)
+        {
+            auto *new_records = new Order[CHUNK_SIZE];
+            if (chunk.compare_exchange_strong(records, new_records, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                records = new_records;
+            }
+            else
+            {
+                delete[] new_records;
+            }
+        }
+
+        return publish(records[idx % CHUNK_SIZE], idx);
+    }
+
+    /**
+     * @brief Return a record to the pool. Its handle stops resolving immediately,
+     * reports that still carry it are rejected by get().
+     */
+    void release(Order *order)
+    {
+        // seq_cst with the handle check of pin(), see reuse()
+        auto handle = order->handle_.exchange(0, std::memory_order_seq_cst);
+        if (!handle)
+        {
+            return;
+        }
+        live_.fetch_sub(1, std::memory_order_relaxed);
+        std::lock_guard lock(free_mutex_);
+        free_.push_back(index(handle));
+    }
+
+    /**
+     * @brief Resolve a handle, nullptr if it is out of range or of another generation.
+     */
+    Order* get(uint32_t handle) const noexcept
+    {
+        auto idx = index(handle);
+        if (!handle || idx >= size())
+        {
+            return nullptr;
+        }
+
+        auto *records = chunks_[idx / CHUNK_SIZE].load(std::memory_order_acquire);
+        if (!records)
+        {
+            return nullptr;
+        }
+
+        auto &order = records[idx % CHUNK_SIZE];
+        return order.handle_.load(std::memory_order_acquire) == handle ? &order : nullptr;
+    }
+
+    Order* get(const void *context) const noexcept
+    {
+        auto value = reinterpret_cast<uintptr_t>(context);
+        return value <= UINT32_MAX ? get(static_cast<uint32_t>(value)) : nullptr;
+    }
+
+    /**
+     * @brief Resolve a handle like get() and keep the slot from being reused while the Pin lives.
+     */
+    Pin pin(uint32_t handle) const noexcept
+    {
+        auto *order = handle ? at(index(handle)) : nullptr;
+        if (!order)
+        {
+            return Pin{};
+        }
+
+        // pin first, then check the handle. Either reuse() sees the pin or this load sees the release.
+        order->pins_.fetch_add(1, std::memory_order_seq_cst);
+        if (order->handle_.load(std::memory_order_seq_cst) != handle)
+        {
+            order->pins_.fetch_sub(1, std::memory_order_release);
+            return Pin{};
+        }
+        return Pin(order);
+    }
+
+    Pin pin(const void *context) const noexcept
+    {
+        auto value = reinterpret_cast<uintptr_t>(context);
+        return value <= UINT32_MAX ? pin(static_cast<uint32_t>(value)) : Pin{};
+    }
+
+    /**
+     * @brief Record at a slot index regardless of its generation, nullptr if it was never allocated.
+     * A released slot has a handle_ of 0.
+     */
+    Order* at(uint32_t idx) const noexcept
+    {
+        if (idx >= size())
+        {
+            return nullptr;
+        }
+        auto *records = chunks_[idx / CHUNK_SIZE].load(std::memory_order_acquire);
+        return records ? &records[idx % CHUNK_SIZE] : nullptr;
+    }
+
+    uint32_t size() const noexcept { return std::min(next_index_.load(std::memory_order_acquire), capacity_); }
+    uint32_t capacity() const noexcept { return capacity_; }
+    uint32_t live() const noexcept { return live_.load(std::memory_order_relaxed); }
+    uint64_t recycled() const noexcept { return recycled_.load(std::memory_order_relaxed); }
+
+private:
+    // free_mutex_ held. nullptr if every free slot is still pinned.
+    Order* reuse() noexcept
+    {
+        for (auto n = free_.size(); n; --n)
+        {
+            auto idx = free_.front();
+            free_.pop_front();
+            auto &order = chunks_[idx / CHUNK_SIZE].load(std::memory_order_relaxed)[idx % CHUNK_SIZE];
+            // acquire the unpin so the callback's last access happens before the reset
+            if (order.pins_.load(std::memory_order_seq_cst))
+            {
+                // a late report still holds the record, try it again after the others
+                free_.push_back(idx);
+                continue;
+            }
+            order.reset();
+            recycled_.fetch_add(1, std::memory_order_relaxed);
+            return publish(order, idx);
+        }
+        return nullptr;
+    }
+
+    Order* publish(Order &order, uint32_t idx) noexcept
+    {
+        order.generation_ = order.generation_ % MAX_GENERATION + 1;
+        live_.fetch_add(1, std::memory_order_relaxed);
+        order.handle_.store(idx | (order.generation_ << INDEX_BITS), std::memory_order_release);
+        return &order;
+    }
+};
+
+}   // namespace zorro
@@ -0,0 +1,56 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include "order.h"
+#include "waiter.h"
+
+namespace zorro {
+
+/**
+ * @brief Wait until a report completes the request of the order. The caller sets the request
+ * flag in Order::requests_ before the engine call, it is cleared here if the wait fails.
+ */
+inline WaitResult waitOrder(Waiter &waiter, Order *order, OrderRequest request, WaitSite site, uint64_t timeout_ms = 0)
+{
+    auto result = waiter.wait(site, [order, request]() { return !(order->requests_.load(std::memory_order_acquire) & request); }, timeout_ms);
+    if (result != WaitResult::Done)
+    {
+        order->requests_.fetch_and((uint8_t)~request, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+/**
+ * @brief Clear completed requests of the order and wake up their waiters. Called by report callbacks
+ * after the report is published in the order.
+ */
+inline void completeOrder(Waiter &waiter, Order *order, uint8_t requests)
+{
+    if (order->requests_.fetch_and((uint8_t)~requests, std::memory_order_acq_rel) & requests)
+    {
+        waiter.signal();
+    }
+}
+
+}   // namespace zorro
@@ -0,0 +1,166 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <spdlog/spdlog.h>
+
+namespace zorro {
+
+/**
+ * @brief Provisional trade ids of asynchronous orders and the order numbers they resolved to, kept on disk.
+ *
+ * Zorro stores the trade id returned by BrokerBuy2 and asks for it again after a re-login or a restart,
+ * when the RithmicClient that issued it is gone. The id is also written into the order tag, so an order
+ * that is still open is recovered from the open order replay. Once its order number is known it is
+ * recorded here, which also covers orders that completed in the meantime.
+ *
+ * One line per id: provisional_id,order_num,time. The first line holds the next id to issue, so ids stay
+ * unique across sessions. Entries older than EXPIRY_S are dropped on load. Not thread safe, RithmicClient
+ * accesses it under orders_mutex_, which also guards orders_by_id_.
+ */
+class ProvisionalIds
+{
+public:
+    static constexpr uint32_t BASE = 2000000000;
+    static constexpr uint64_t EXPIRY_S = 30 * 86400;    // a GTC trade can stay open for weeks
+
+private:
+    struct Entry
+    {
+        uint32_t order_num_ = 0;    // 0 until the order is acknowledged
+        uint64_t time_ = 0;         // seconds since epoch when the id was issued
+    };
+
+    std::string path_;
+    uint32_t next_ = BASE;
+    std::unordered_map<uint32_t, Entry> entries_;
+    bool dirty_ = false;
+
+public:
+    void load(const std::string &path, uint64_t now_s)
+    {
+        path_ = path;
+        std::ifstream file(path_);
+        std::string line;
+        if (std::getline(file, line))
+        {
+            next_ = std::max<uint32_t>(BASE, (uint32_t)std::strtoul(line.c_str(), nullptr, 10));
+        }
+        while (std::getline(file, line))
+        {
+            std::istringstream fields(line);
+            std::string id, order_num, time;
+            if (std::getline(fields, id, ',') && std::getline(fields, order_num, ',') && std::getline(fields, time, ','))
+            {
+                Entry entry{(uint32_t)std::strtoul(order_num.c_str(), nullptr, 10), std::strtoull(time.c_str(), nullptr, 10)};
+                if (now_s - entry.time_ <= EXPIRY_S)
+                {
+                    entries_[(uint32_t)std::strtoul(id.c_str(), nullptr, 10)] = entry;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Issue the next provisional id. Wraps to BASE after INT32_MAX.
+     */
+    uint32_t issue(uint64_t now_s)
+    {
+        auto id = next_;
+        next_ = next_ < INT32_MAX ? next_ + 1 : BASE;
+        entries_[id] = Entry{0, now_s};
+        dirty_ = true;
+        return id;
+    }
+
+    /**
+     * @brief Make sure an id recovered from an order tag is never issued again.
+     */
+    void reserve(uint32_t id, uint32_t order_num, uint64_t now_s)
+    {
+        if (id >= next_ && id < INT32_MAX)
+        {
+            next_ = id + 1;
+        }
+        resolve(id, order_num, now_s);
+    }
+
+    void resolve(uint32_t id, uint32_t order_num, uint64_t now_s)
+    {
+        auto &entry = entries_[id];
+        if (entry.order_num_ != order_num)
+        {
+            entry.order_num_ = order_num;
+            entry.time_ = entry.time_ ? entry.time_ : now_s;
+            dirty_ = true;
+        }
+    }
+
+    /**
+     * @brief Order number of a provisional id, 0 if unknown or not acknowledged yet.
+     */
+    uint32_t orderNum(uint32_t id) const
+    {
+        auto iter = entries_.find(id);
+        return iter != entries_.end() ? iter->second.order_num_ : 0;
+    }
+
+    bool save()
+    {
+        if (path_.empty() || !dirty_)
+        {
+            return false;
+        }
+        std::ofstream file(path_, std::ios::trunc);
+        if (!file)
+        {
+            SPDLOG_ERROR("Failed to write {}", path_);
+            return false;
+        }
+        file << next_ << '\n';
+        for (auto &[id, entry] : entries_)
+        {
+            file << std::format("{},{},{}\n", id, entry.order_num_, entry.time_);
+        }
+        dirty_ = false;
+        return true;
+    }
+};
+
+/**
+ * @brief Provisional id written after the client order id into a ZORRO_ tag, 0 if there is none.
+ */
+inline uint32_t provisionalId(std::string_view tag)
+{
+    auto pos = tag.find('_', 6);
+    return pos == std::string_view::npos ? 0 : (uint32_t)std::strtoul(std::string(tag.substr(pos + 1)).c_str(), nullptr, 10);
+}
+
+}   // namespace zorro
@@ -0,0 +1,252 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "symbol.h"
+#include "utils.h"
+
+namespace zorro {
+
+/**
+ * @brief RefData or PriceIncrUpdate reply copied out of the RApi callback.
+ *
+ * getRefData and getPriceIncrInfo take no request context, so the reply can only be matched to its
+ * symbol by name. The callback queues the copy and the Zorro thread, which owns the name map, applies it.
+ */
+struct RefDataReply
+{
+    RefPending kind_ = rp_RefData;
+    bool ok_ = false;
+    std::string symbol_;
+    std::string product_;
+    std::string type_;
+    bool tradable_ = false;
+    bool has_size_multiplier_ = false;
+    double size_multiplier_ = 1.;
+    bool has_min_size_increment_ = false;
+    int64_t min_size_increment_ = 0;
+    double price_increment_ = 0.;
+};
+
+/**
+ * @brief On-disk cache of the reference data and price increment of every asset used.
+ *
+ * One line per asset: asset,time,price_increment,size_multiplier,min_size_increment,tradable,product,type.
+ * Product and type come from R|API and are percent-escaped, a line that doesn't parse completely is dropped.
+ * Entries older than the expiry are ignored and fetched again. Only used by the Zorro thread.
+ */
+class RefDataCache
+{
+    struct Entry
+    {
+        uint64_t time_ = 0;     // seconds since epoch when the entry was fetched
+        double price_increment_ = 0.;
+        double size_multiplier_ = 1.;
+        int64_t min_size_increment_ = 0;
+        bool tradable_ = false;
+        std::string product_;
+        std::string type_;
+    };
+
+    std::string path_;
+    uint64_t expiry_s_ = 0;
+    std::unordered_map<std::string, Entry, StringHash, std::equal_to<>> entries_;
+
+public:
+    void load(const std::string &path, uint64_t expiry_s)
+    {
+        path_ = path;
+        expiry_s_ = expiry_s;
+        std::ifstream file(path_);
+        std::string line;
+        uint32_t dropped = 0;
+        while (std::getline(file, line))
+        {
+            std::string asset;
+            Entry entry;
+            if (parse(line, asset, entry))
+            {
+                entries_[asset] = std::move(entry);
+            }
+            else if (!line.empty())
+            {
+                ++dropped;
+            }
+        }
+        SPDLOG_INFO("{} ref data entries loaded from {}, {} malformed lines dropped", entries_.size(), path_, dropped);
+    }
+
+    /**
+     * @brief Fill the spec from a fresh cache entry.
+     * @return false if there is no entry or it expired
+     */
+    bool apply(Spec &spec, uint64_t now_s) const
+    {
+        auto iter = entries_.find(std::string_view(spec.symbol_));
+        if (iter == entries_.end() || now_s - iter->second.time_ > expiry_s_ || iter->second.price_increment_ <= 0)
+        {
+            return false;
+        }
+        auto &entry = iter->second;
+        spec.ref_time_ = entry.time_;
+        spec.price_increment_ = entry.price_increment_;
+        spec.size_muliplier = entry.size_multiplier_;
+        spec.min_size_increment_ = entry.min_size_increment_;
+        spec.tradable_ = entry.tradable_;
+        spec.product_ = entry.product_;
+        spec.type_ = entry.type_;
+        spec.ref_valid_ = true;
+        return true;
+    }
+
+    void update(const Spec &spec)
+    {
+        if (!spec.ref_valid_ || !spec.ref_time_ || spec.price_increment_ <= 0)
+        {
+            // failed or incomplete replies are fetched again next session
+            return;
+        }
+        auto &entry = entries_[spec.symbol_];
+        entry.time_ = spec.ref_time_;
+        entry.price_increment_ = spec.price_increment_;
+        entry.size_multiplier_ = spec.size_muliplier;
+        entry.min_size_increment_ = spec.min_size_increment_;
+        entry.tradable_ = spec.tradable_;
+        entry.product_ = spec.product_;
+        entry.type_ = spec.type_;
+    }
+
+    bool save() const
+    {
+        if (path_.empty())
+        {
+            return false;
+        }
+        std::ofstream file(path_, std::ios::trunc);
+        if (!file)
+        {
+            SPDLOG_ERROR("Failed to write {}", path_);
+            return false;
+        }
+        for (auto &[asset, entry] : entries_)
+        {
+            file << std::format("{},{},{},{},{},{},{},{}\n", asset, entry.time_, entry.price_increment_, entry.size_multiplier_,
+                entry.min_size_increment_, entry.tradable_ ? 1 : 0, escape(entry.product_), escape(entry.type_));
+        }
+        return true;
+    }
+
+private:
+    static constexpr uint32_t N_FIELDS = 8;
+
+    // product and type are free text, the separators and the escape character are written as %XX
+    static std::string escape(std::string_view value)
+    {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (auto c : value)
+        {
+            if (c == ',' || c == '%' || c == '\n' || c == '\r')
+            {
+                escaped += std::format("%{:02X}", (unsigned char)c);
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    static bool unescape(std::string_view value, std::string &out)
+    {
+        out.clear();
+        for (size_t i = 0; i < value.size(); ++i)
+        {
+            if (value[i] != '%')
+            {
+                out += value[i];
+                continue;
+            }
+            unsigned int c;
+            if (i + 2 >= value.size() || std::from_chars(value.data() + i + 1, value.data() + i + 3, c, 16).ptr != value.data() + i + 3)
+            {
+                return false;
+            }
+            out += (char)c;
+            i += 2;
+        }
+        return true;
+    }
+
+    template<typename T>
+    static bool parseNumber(std::string_view field, T &value)
+    {
+        auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+        return !field.empty() && result.ec == std::errc() && result.ptr == field.data() + field.size();
+    }
+
+    static bool parse(std::string_view line, std::string &asset, Entry &entry)
+    {
+        std::array<std::string_view, N_FIELDS> fields;
+        uint32_t n = 0;
+        size_t start = 0;
+        while (true)
+        {
+            auto end = line.find(',', start);
+            if (n == N_FIELDS)
+            {
+                return false;   // too many fields
+            }
+            fields[n++] = line.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+            if (end == std::string_view::npos)
+            {
+                break;
+            }
+            start = end + 1;
+        }
+        if (n != N_FIELDS || fields[0].empty())
+        {
+            return false;
+        }
+
+        int tradable;
+        if (!parseNumber(fields[1], entry.time_) || !parseNumber(fields[2], entry.price_increment_) || !parseNumber(fields[3], entry.size_multiplier_) ||
+            !parseNumber(fields[4], entry.min_size_increment_) || !parseNumber(fields[5], tradable) || tradable < 0 || tradable > 1 ||
+            !unescape(fields[6], entry.product_) || !unescape(fields[7], entry.type_))
+        {
+            return false;
+        }
+        entry.tradable_ = tradable == 1;
+        asset = fields[0];
+        return true;
+    }
+};
+
+}   // namespace zorro
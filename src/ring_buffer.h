@@ -0,0 +1,128 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include "seqlock.h"
+
+namespace zorro {
+
+/**
+ * @brief Fixed capacity single writer ring that overwrites its oldest entries.
+ *
+ * Every pushed value gets a monotonically increasing sequence number. Each slot is a SeqLock
+ * that also stores the sequence number of its value, so readers can copy a range without
+ * blocking the writer and detect entries that were overwritten while copying.
+ */
+template<typename T, uint32_t N>
+class SeqRing
+{
+    static_assert(N && (N & (N - 1)) == 0, "SeqRing capacity must be a power of 2");
+
+    struct Entry
+    {
+        uint64_t seq_;
+        T value_;
+    };
+
+    std::atomic<uint64_t> head_{0};     // sequence number of the next value
+    std::array<SeqLock<Entry>, N> slots_;
+
+public:
+    static constexpr uint32_t capacity() noexcept { return N; }
+
+    /**
+     * @brief Append a value. Single writer only.
+     * @return the sequence number of the value
+     */
+    uint64_t push(const T &value) noexcept
+    {
+        auto seq = head_.load(std::memory_order_relaxed);
+        slots_[seq & (N - 1)].store(Entry{seq, value});
+        head_.store(seq + 1, std::memory_order_release);
+        return seq;
+    }
+
+    /**
+     * @brief Sequence number the next pushed value will get.
+     */
+    uint64_t head() const noexcept { return head_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copy the values with sequence number >= since, oldest first.
+     * @param fn called with (seq, value) for every copied value
+     * @return number of values visited
+     */
+    template<typename Fn>
+    uint32_t readSince(uint64_t since, uint32_t max_count, Fn &&fn) const noexcept
+    {
+        auto head = head_.load(std::memory_order_acquire);
+        auto start = std::max(since, head > N ? head - N : 0);
+        uint32_t n = 0;
+        for (auto seq = start; seq < head && n < max_count; ++seq)
+        {
+            auto entry = slots_[seq & (N - 1)].load();
+            if (entry.seq_ != seq)
+            {
+                // overwritten by the writer while copying
+                continue;
+            }
+            fn(seq, entry.value_);
+            ++n;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Visit the retained values newest first until fn returns false.
+     * @param fn called with (seq, value), stops at the first value that was overwritten while reading
+     */
+    template<typename Fn>
+    void readReverse(Fn &&fn) const noexcept
+    {
+        auto head = head_.load(std::memory_order_acquire);
+        auto oldest = head > N ? head - N : 0;
+        for (auto seq = head; seq-- > oldest;)
+        {
+            auto entry = slots_[seq & (N - 1)].load();
+            if (entry.seq_ != seq || !fn(seq, entry.value_))
+            {
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Copy the last count values, oldest first.
+     */
+    template<typename Fn>
+    uint32_t readLast(uint32_t count, Fn &&fn) const noexcept
+    {
+        auto head = head_.load(std::memory_order_acquire);
+        return readSince(head > count ? head - count : 0, count, std::forward<Fn>(fn));
+    }
+};
+
+}   // namespace zorro
@@ -19,6 +19,7 @@
 #include "stdafx.h"
 
 #include "rithmic_zorro_plugin.h"
+#include "broker_commands.h"
 #include "client.h"
 #include "config.h"
 #include "global.h"
@@ -43,6 +44,205 @@ namespace {
 
     auto &global = zorro::Global::get();
     auto &config = zorro::Config::get();
+
+    /**
+     * @brief Fill price, spread and volume of a ready symbol as configured by SET_PRICETYPE and SET_VOLTYPE.
+     * Shared by BrokerAsset and the batched GET_QUOTES.
+     */
+    void readQuote(zorro::Symbol &symbol, int32_t price_type, int32_t vol_type, double *pPrice, double *pSpread, double *pVolume)
+    {
+        using namespace zorro;
+        client_->notifier().consume(symbol.handle_);
+        auto top = symbol.top_.load();
+        auto last_trade = symbol.last_trade_.load();
+        if (symbol.latency_)
+        {
+            auto unread_since = symbol.latency_->unread_since_.exchange(0, std::memory_order_acq_rel);
+            if (unread_since)
+            {
+                (*symbol.latency_)[LatencyStage::Read].record(get_timestamp_ns() - unread_since);
+            }
+        }
+        switch (price_type)
+        {
+        case 2:
+            *pPrice = !std::isnan(last_trade.price_) ? last_trade.price_ : top.ask_price_;
+            break;
+        case PRICETYPE_MID:
+            *pPrice = !std::isnan(top.mid_price_) ? top.mid_price_ : top.ask_price_;
+            break;
+        case PRICETYPE_MICROPRICE:
+            *pPrice = !std::isnan(top.micro_price_) ? top.micro_price_ : top.ask_price_;
+            break;
+        default:
+            *pPrice = top.ask_price_;
+            break;
+        }
+
+        if (pVolume)
+        {
+            switch(vol_type)
+            {
+                case 0:
+                    if (price_type == 2)
+                    {
+                        *pVolume = last_trade.buy_volume_ - last_trade.sell_volume_;
+                    }
+                    else
+                    {
+                        *pVolume = top.bid_qty_ + top.ask_qty_;
+                    }
+                    break;
+                case 1:
+                    // no volume
+                    break;
+                case 2:
+                    // cumulative delta
+                    *pVolume = last_trade.buy_volume_ - last_trade.sell_volume_;
+                    break;
+                case 3:
+                    *pVolume = top.bid_qty_ + top.ask_qty_;
+                    break;
+                case 4:
+                    *pVolume = last_trade.buy_volume_ - last_trade.sell_volume_;
+                    break;
+                case 5:
+                    *pVolume = top.ask_price_;
+                    break;
+                case 6:
+                    *pVolume = top.bid_price_;
+            }
+        }
+
+        if (pSpread)
+        {
+            if (!std::isnan(top.bid_price_))
+            {
+                *pSpread = top.ask_price_ - top.bid_price_;
+            }
+            else
+            {
+                *pSpread = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Fill the quotes of many assets in one pass over the symbol storage.
+     * An asset is looked up by name only until its handle is known. Never waits, a quote that is
+     * not ready yet is skipped.
+     * @return number of ready quotes
+     */
+    int getQuotes(zorro::QuoteQuery &query)
+    {
+        using namespace zorro;
+        if (!query.quotes || query.n_quotes <= 0)
+        {
+            return 0;
+        }
+
+        auto price_type = global.price_type_.load(std::memory_order_relaxed);
+        auto vol_type = global.vol_type_;
+        auto now = get_timestamp();
+        int n_ready = 0;
+        for (int i = 0; i < query.n_quotes; ++i)
+        {
+            auto &quote = query.quotes[i];
+            quote.ready = 0;
+            Symbol *symbol = nullptr;
+            if (quote.handle >= 0)
+            {
+                symbol = client_->getSymbol((uint32_t)quote.handle);
+                if (symbol && !symbol->subscribed_.load(std::memory_order_relaxed))
+                {
+                    // evicted or unsubscribed, subscribe again by name
+                    symbol = client_->acquireSymbol(symbol->spec_.symbol_.c_str());
+                }
+            }
+            else if (quote.asset)
+            {
+                symbol = client_->acquireSymbol(quote.asset);
+            }
+            if (!symbol)
+            {
+                quote.handle = -1;
+                continue;
+            }
+
+            quote.handle = (int)symbol->handle_;
+            symbol->last_used_ = now;
+            if (!symbol->isReady() || symbol->stale_.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+            readQuote(*symbol, price_type, vol_type, &quote.price, &quote.spread, &quote.volume);
+            quote.ready = 1;
+            ++n_ready;
+        }
+        return n_ready;
+    }
+
+    /**
+     * @brief Fill the legs of a spread from one instant, see RithmicClient::readCut.
+     * @return 1 consistent cut, 0 a leg is not ready or the legs kept changing
+     */
+    int getConsistentQuotes(zorro::CutQuery &query)
+    {
+        using namespace zorro;
+        if (!query.legs || query.n_legs <= 0 || query.n_legs > (int)RithmicClient::MAX_CUT_LEGS)
+        {
+            return 0;
+        }
+
+        std::array<Symbol*, RithmicClient::MAX_CUT_LEGS> symbols;
+        auto now = get_timestamp();
+        for (int i = 0; i < query.n_legs; ++i)
+        {
+            auto &leg = query.legs[i];
+            leg.ready = 0;
+            Symbol *symbol = nullptr;
+            if (leg.handle >= 0)
+            {
+                symbol = client_->getSymbol((uint32_t)leg.handle);
+            }
+            else if (leg.asset)
+            {
+                symbol = client_->acquireSymbol(leg.asset);
+            }
+            if (!symbol || !symbol->subscribed_.load(std::memory_order_relaxed) || !symbol->isReady() || symbol->stale_.load(std::memory_order_acquire))
+            {
+                leg.handle = symbol ? (int)symbol->handle_ : -1;
+                return 0;
+            }
+            leg.handle = (int)symbol->handle_;
+            symbol->last_used_ = now;
+            // the last trade of a leg needs its prints, see RithmicTrimStreams
+            client_->requirePrints(*symbol);
+            symbols[i] = symbol;
+        }
+
+        std::array<MDTop, RithmicClient::MAX_CUT_LEGS> tops;
+        std::array<Trade, RithmicClient::MAX_CUT_LEGS> trades;
+        uint32_t retries;
+        auto consistent = client_->readCut(symbols.data(), query.n_legs, tops.data(), trades.data(), retries);
+        query.retries = (int)retries;
+        uint64_t cut_seq = 0;
+        for (int i = 0; i < query.n_legs; ++i)
+        {
+            auto &leg = query.legs[i];
+            auto leg_seq = std::max(tops[i].update_seq_, trades[i].update_seq_);
+            cut_seq = std::max(cut_seq, leg_seq);
+            leg.bid = tops[i].bid_price_;
+            leg.ask = tops[i].ask_price_;
+            leg.bid_size = (double)tops[i].bid_qty_;
+            leg.ask_size = (double)tops[i].ask_qty_;
+            leg.last = trades[i].price_;
+            leg.seq = (double)leg_seq;
+            leg.ready = 1;
+        }
+        query.seq = (double)cut_seq;
+        return consistent ? 1 : 0;
+    }
 }
 
 namespace zorro
@@ -118,6 +318,11 @@ namespace zorro
             return 0;
         }
 
+        if (!config.subscribe_list_.empty())
+        {
+            client_->subscribeAll(config.subscribe_list_, 10000);
+        }
+
         ShowRithmicLogosDialog();
         SPDLOG_INFO("Login. Account: {}", client_->accountId());
         BrokerError(std::format("Account {}", client_->accountId()).c_str());
@@ -127,19 +332,22 @@ namespace zorro
 
     DLLFUNC_C int BrokerTime(DATE* pTimeGMT)
     {
+        if (client_)
+        {
+            client_->checkStale();
+            client_->retireOrders();
+            client_->reportErrors();
+            client_->applyRefData();
+        }
         return 2;
     }
 
     DLLFUNC_C int BrokerAsset(char* Asset, double* pPrice, double* pSpread, double* pVolume, double* pPip, double* pPipCost, double* pLotAmount, double* pMarginCost, double* pRollLong, double* pRollShort)
     {
-        auto *symbol = client_->getSymbol(Asset);
+        auto *symbol = client_->acquireSymbol(Asset);
         if (!symbol)
         {
-            if (!client_->subscribe(Asset))
-            {
-                return 0;
-            }
-            symbol = client_->getSymbol(Asset);
+            return 0;
         }
 
         if (!pPrice)
@@ -147,83 +355,43 @@ namespace zorro
             return 1;
         }
 
-        auto start = get_timestamp();
-        while(symbol->ready_.load(std::memory_order_relaxed).to_ulong() < 3)
+        if (symbol->stale_.load(std::memory_order_acquire))
         {
-            if (!BrokerProgress(1))
-            {
-                return 0;
-            }
-
-            if ((get_timestamp() - start) > 10000)
-            {
-                BrokerError(std::format("{} no data", Asset).c_str());
-                return 0;
-            }
+            // resubscribed by the watchdog, don't serve the last quote until fresh data arrives
+            return 0;
         }
 
-        auto top = symbol->top_.load(std::memory_order_relaxed);
-        auto last_trade = symbol->last_trade_.load(std::memory_order_relaxed);
-        if (global.price_type_.load(std::memory_order_relaxed) == 2)
-        {
-            if (!std::isnan(last_trade.price_))
-            {
-                *pPrice = last_trade.price_;
-            }
-            else
-            {
-                *pPrice = top.ask_price_;
-            }
-        }
-        else
+        switch (client_->waiter().wait(WaitSite::Asset, [symbol]() { return symbol->isReady(); }, 10000))
         {
-            *pPrice = top.ask_price_;
+        case WaitResult::Aborted:
+            return 0;
+        case WaitResult::Timeout:
+            BrokerError(std::format("{} no data", Asset).c_str());
+            return 0;
+        default:
+            break;
         }
 
-        if (pVolume)
+        readQuote(*symbol, global.price_type_.load(std::memory_order_relaxed), global.vol_type_, pPrice, pSpread, pVolume);
+
+        // only known once the reference data or the cache provided them, otherwise Zorro keeps the asset list values
+        client_->applyRefData();
+        auto &spec = symbol->spec_;
+        bool ref_data = symbol->hasRefData() && spec.ref_valid_;
+        double lot_amount = spec.min_size_increment_ > 0 ? (double)spec.min_size_increment_ : 1.;
+        if (pLotAmount && ref_data)
         {
-            switch(global.vol_type_)
-            {
-                case 0:
-                    if (global.price_type_.load(std::memory_order_relaxed) == 2)
-                    {
-                        *pVolume = last_trade.buy_volume_ - last_trade.sell_volume_;
-                    }
-                    else
-                    {
-                        *pVolume = top.bid_qty_ + top.ask_qty_;
-                    }
-                    break;
-                case 1:
-                    // no volume
-                    break;
-                case 2:
-                    // cumulative delta
-                    *pVolume = last_trade.buy_volume_ - last_trade.sell_volume_;
-                    break;
-                case 3:
-                    *pVolume = top.bid_qty_ + top.ask_qty_;
-                    break;
-                case 4:
-                    *pVolume = last_trade.buy_volume_ - last_trade.sell_volume_;
-                    break;
-                case 5:
-                    *pVolume = top.ask_price_;
-                    break;
-                case 6:
-                    *pVolume = top.bid_price_;
-            }
+            *pLotAmount = lot_amount;
         }
-
-        if (pSpread)
+        if (spec.price_increment_ > 0)
         {
-            if (!std::isnan(top.bid_price_))
+            if (pPip)
             {
-                *pSpread = top.ask_price_ - top.bid_price_;
+                *pPip = spec.price_increment_;
             }
-            else
+            if (pPipCost && ref_data)
             {
-                *pSpread = 0;
+                *pPipCost = spec.price_increment_ * spec.size_muliplier * lot_amount;
             }
         }
         return 1;
@@ -239,7 +407,22 @@ namespace zorro
         auto start = convertTime(tStart);
         auto end = convertTime(tEnd);
         SPDLOG_TRACE("BrokerHistory2 Asset={} tStart={}({}) tEnd={}({}) nTickMinutes={} nTicks={}", Asset, timeToString(start), start, timeToString(end), end, nTickMinutes, nTicks);
-        const auto &downloaded = client_->replayBars(Asset, start, end, nTickMinutes, nTicks);
+
+        // recent bars come from the live bar builder, only the older gap is requested from the server
+        int64_t covered_from;
+        auto n_live = client_->liveBars(Asset, start, end, nTickMinutes, nTicks, ticks, covered_from);
+        if (n_live)
+        {
+            SPDLOG_TRACE("{} live bars. {} - {}", n_live, timeToString(convertTime(ticks[0].time)), timeToString(convertTime(ticks[n_live - 1].time)));
+            ticks += n_live;
+        }
+
+        if (n_live >= nTicks || start >= covered_from)
+        {
+            return n_live;
+        }
+
+        const auto &downloaded = client_->replayBars(Asset, start, std::min<int64_t>(end, covered_from), nTickMinutes, nTicks - n_live);
         if (!downloaded.empty())
         {
             SPDLOG_TRACE("downloaded {} bars. {} - {}", downloaded.size(), timeToString(convertTime(downloaded.front().time)), timeToString(convertTime(downloaded.back().time)));
@@ -249,7 +432,7 @@ namespace zorro
                 ++ticks;
             }
         }
-        return (int)downloaded.size();
+        return n_live + (int)downloaded.size();
     }
 
     DLLFUNC_C int BrokerAccount(char* Account, double* pdBalance, double* pdTradeVal, double* pdMarginVal)
@@ -297,27 +480,27 @@ namespace zorro
             return 0;
         }
 
-        if (order->completion_reason_.pData && 
-            (order->completion_reason_ == RApi::sCOMPLETION_REASON_FAILURE ||
-            order->completion_reason_ == RApi::sCOMPLETION_REASON_CANCEL ||
-            order->completion_reason_ == RApi::sCOMPLETION_REASON_REJECT))
+        auto state = order->state_.load();
+        if (state.completion_reason_ == CompletionReason::Failure ||
+            state.completion_reason_ == CompletionReason::Cancel ||
+            state.completion_reason_ == CompletionReason::Reject)
         {
-            SPDLOG_TRACE("BrokerBuy2 Order {}, return 0. complete reason {}", order->order_num_, to_string_view(order->completion_reason_));
+            SPDLOG_TRACE("BrokerBuy2 Order {}, return 0. complete reason {}", state.order_num_, to_string(state.completion_reason_));
             return 0;
         }
 
-        if (order->exec_qty_)
+        if (state.exec_qty_)
         {
             if (pPrice)
             {
-                *pPrice = order->avg_fill_price_;
+                *pPrice = state.avg_fill_price_;
             }
             if (pFill)
             {
-                *pFill = static_cast<int>(order->exec_qty_);
+                *pFill = static_cast<int>(state.exec_qty_);
             }
-            SPDLOG_TRACE("BrokerBuy2 return Order {}, pFill: {}", order->order_num_, *pFill);
-            return order->order_num_;
+            SPDLOG_TRACE("BrokerBuy2 return Order {}, pFill: {}", order->trade_id_, *pFill);
+            return order->trade_id_;
         }
 
         if (pFill)
@@ -325,43 +508,44 @@ namespace zorro
             *pFill = 0;
         }
 
-        SPDLOG_TRACE("BrokerBuy2 return Order {} pFill: 0", order->order_num_);
-        return order->order_num_;
+        SPDLOG_TRACE("BrokerBuy2 return Order {} pFill: 0", order->trade_id_);
+        return order->trade_id_;
     }
 
     DLLFUNC_C int BrokerTrade(int nTradeID, double* pOpen, double* pClose, double* pCost, double *pProfit)
     {
         SPDLOG_INFO("BrokerTrade: {}", nTradeID);
-        auto order = client_->retrieveOrder(nTradeID);
+        auto *order = client_->retrieveOrder(nTradeID);
         if (order)
         {
-            if (order->cancelled_)
+            auto state = order->state_.load();
+            if (state.cancelled_ || state.completion_reason_ == CompletionReason::Reject || state.completion_reason_ == CompletionReason::Failure)
             {
                 return NAY - 1;
             }
 
-            if (order->exec_qty_)
+            if (state.exec_qty_)
             {
                 if (pOpen)
                 {
-                    *pOpen = order->avg_fill_price_;
+                    *pOpen = state.avg_fill_price_;
                 }
             }
 
-            if (order->exec_qty_ >= order->qty_)
+            if (state.exec_qty_ >= state.qty_)
             {
-                auto position = client_->getPosition(order->symbol_.c_str());
+                auto position = client_->getPosition(order->symbol_);
                 if (position.timestamp_)
                 {
-                    if ((order->side_ == Side::Buy && position.quantity_ <= 0) ||
-                        (order->side_ == Side::Sell && position.quantity_ >= 0))
+                    if ((state.side_ == Side::Buy && position.quantity_ <= 0) ||
+                        (state.side_ == Side::Sell && position.quantity_ >= 0))
                     {
                         // the trade was completed closed
                         return -1;
                     }
                 }
             }
-            return order->exec_qty_;
+            return state.exec_qty_;
         }
         BrokerError(std::format("Order {} not found", nTradeID).c_str());
         return NAY - 1;
@@ -392,6 +576,17 @@ namespace zorro
         case GET_LOCK:
             return -1;
 
+        case GET_BOOK:
+        {
+            auto n = client_->getBook(global.symbol_.c_str(), (T2*)parameter, MAX_QUOTES - 1);
+            if (n)
+            {
+                ((T2*)parameter)[n].time = 0;
+            }
+            SPDLOG_TRACE("GET_BOOK {}: {} quotes", global.symbol_, n);
+            return n;
+        }
+
         case GET_POSITION: {
             global.last_position_ = client_->getPosition((char*)parameter);
             SPDLOG_DEBUG("GET_POSITION {}: {}@{}", (char*)parameter, global.last_position_.quantity_, global.last_position_.average_price_);
@@ -438,7 +633,7 @@ namespace zorro
         }
 
         case SET_WAIT:
-            global.wait_time_ = (int)parameter * 1000000;
+            global.wait_time_ = (uint64_t)std::max<int64_t>((int64_t)parameter, 0) * 1000000;  // ms to ns, in 64 bit
             SPDLOG_TRACE("SET_WAIT: {} ns", global.wait_time_);
             return parameter;
 
@@ -447,8 +642,12 @@ namespace zorro
 
         case SET_PRICETYPE:
         {
-            global.price_type_.store((int)parameter, std::memory_order_release);
+            auto changed = global.price_type_.exchange((int)parameter, std::memory_order_acq_rel) != (int)parameter;
             SPDLOG_TRACE("SET_PRICETYPE: {}", (int)parameter);
+            if (changed && client_)
+            {
+                client_->updateStreams();
+            }
             return parameter;
         }
 
@@ -489,7 +688,7 @@ namespace zorro
             return parameter;
         }
 
-        case 2000:
+        case SET_LOG_LEVEL:
         {
             auto level = (int)parameter;
             if (level < SPDLOG_LEVEL_TRACE || level > SPDLOG_LEVEL_OFF)
@@ -506,7 +705,7 @@ namespace zorro
             return parameter;
         }
 
-        case 2001:
+        case SET_DAY_ORDER:
         {
             if ((int)parameter)
             {
@@ -521,6 +720,210 @@ namespace zorro
             return parameter;
         }
 
+        case GET_TRADE_PRINTS:
+        {
+            auto *query = (TradeQuery*)parameter;
+            if (!query)
+            {
+                return 0;
+            }
+            return client_->getTrades(global.symbol_.c_str(), *query);
+        }
+
+        case SUBSCRIBE_ASSETS:
+            if (!parameter)
+            {
+                return 0;
+            }
+            return client_->subscribeAll((char*)parameter, 10000);
+
+        case GET_READY_LATENCY:
+        {
+            auto *symbol = client_->getSymbol(global.symbol_);
+            if (!symbol || !symbol->isReady())
+            {
+                return -1;
+            }
+            return (double)(symbol->ready_time_.load(std::memory_order_relaxed) - symbol->subscribe_time_);
+        }
+
+        case SET_MARKET_DEPTH:
+            global.market_depth_ = (int)parameter != 0;
+            SPDLOG_TRACE("SET_MARKET_DEPTH: {}", global.market_depth_);
+            return parameter;
+
+        case SET_DAILY_STATS:
+            global.daily_stats_ = (int)parameter != 0;
+            SPDLOG_TRACE("SET_DAILY_STATS: {}", global.daily_stats_);
+            return parameter;
+
+        case SET_ASYNC_ORDERS:
+            global.async_orders_ = (int)parameter != 0;
+            SPDLOG_TRACE("SET_ASYNC_ORDERS: {}", global.async_orders_);
+            return parameter;
+
+        case GET_DAILY_STATS:
+        {
+            auto *info = (DailyStatsInfo*)parameter;
+            auto *symbol = client_->getSymbol(global.symbol_);
+            if (!info || !symbol || !(symbol->subscribe_flags_ & MD_OPEN_INTEREST))
+            {
+                return 0;
+            }
+            auto stats = symbol->daily_.load();
+            info->open = stats.open_;
+            info->high = stats.high_;
+            info->low = stats.low_;
+            info->close = stats.close_;
+            info->settlement = stats.settlement_;
+            info->open_interest = (double)stats.open_interest_;
+            info->time = stats.time_ ? nanosec_to_date(stats.time_) : 0.;
+            return 1;
+        }
+
+        case GET_WAIT_STATS:
+        {
+            auto *stats = (WaitStats*)parameter;
+            if (!stats)
+            {
+                return 0;
+            }
+            for (uint8_t i = 0; i < (uint8_t)WaitSite::__count__; ++i)
+            {
+                auto &site_stats = client_->waiter().stats((WaitSite)i);
+                stats[i].calls = (double)site_stats.calls_.load(std::memory_order_relaxed);
+                stats[i].blocked = (double)site_stats.blocked_.load(std::memory_order_relaxed);
+                stats[i].wait_ms = site_stats.wait_us_.load(std::memory_order_relaxed) / 1000.;
+                stats[i].max_wait_ms = site_stats.max_wait_us_.load(std::memory_order_relaxed) / 1000.;
+                stats[i].cpu_ms = site_stats.cpu_us_.load(std::memory_order_relaxed) / 1000.;
+            }
+            return (double)WaitSite::__count__;
+        }
+
+        case GET_INGRESS_STATS:
+        {
+            auto *info = (IngressStatsInfo*)parameter;
+            if (!info)
+            {
+                return 0;
+            }
+            auto &stats = client_->ingressStats();
+            auto callbacks = stats.callbacks_.load(std::memory_order_relaxed);
+            info->md_events = (double)stats.md_events_.load(std::memory_order_relaxed);
+            info->pnl_events = (double)stats.pnl_events_.load(std::memory_order_relaxed);
+            info->stalls = (double)stats.stalls_.load(std::memory_order_relaxed);
+            info->callbacks = (double)callbacks;
+            info->callback_avg_us = callbacks ? stats.callback_ns_.load(std::memory_order_relaxed) / 1000. / callbacks : 0.;
+            info->callback_max_us = stats.max_callback_ns_.load(std::memory_order_relaxed) / 1000.;
+            return 1;
+        }
+
+        case GET_STREAM_STATS:
+        {
+            auto *info = (StreamStatsInfo*)parameter;
+            if (!info)
+            {
+                return 0;
+            }
+            *info = client_->streamStats();
+            return 1;
+        }
+
+        case UNSUBSCRIBE_ASSET:
+            if (!parameter)
+            {
+                return -1;
+            }
+            return client_->releaseSymbol((char*)parameter);
+
+        case GET_SUBSCRIPTIONS:
+        {
+            auto *query = (SubscriptionQuery*)parameter;
+            if (!query)
+            {
+                return 0;
+            }
+            return client_->getSubscriptions(*query);
+        }
+
+        case GET_QUOTES:
+        {
+            auto *query = (QuoteQuery*)parameter;
+            if (!query)
+            {
+                return 0;
+            }
+            return getQuotes(*query);
+        }
+
+        case GET_CONSISTENT_QUOTES:
+        {
+            auto *query = (CutQuery*)parameter;
+            if (!query)
+            {
+                return 0;
+            }
+            return getConsistentQuotes(*query);
+        }
+
+        case GET_SESSION_STATS:
+        {
+            auto *info = (SessionInfo*)parameter;
+            auto *symbol = client_->getSymbol(global.symbol_);
+            if (!info || !symbol)
+            {
+                return 0;
+            }
+            client_->requirePrints(*symbol);
+            auto stats = symbol->session_.load();
+            info->start = stats.start_time_ ? nanosec_to_date(stats.start_time_) : 0.;
+            info->vwap = stats.vwap();
+            info->high = stats.high_;
+            info->low = stats.low_;
+            info->trades = (double)stats.trades_;
+            info->volume = (double)stats.volume_;
+            info->buy_volume = (double)stats.buy_volume_;
+            info->sell_volume = (double)stats.sell_volume_;
+            info->delta = (double)stats.delta();
+            return 1;
+        }
+
+        case GET_LATENCY:
+        {
+            auto *info = (LatencyInfo*)parameter;
+            auto *symbol = client_->getSymbol(global.symbol_);
+            if (!info || !symbol || !symbol->latency_)
+            {
+                return 0;
+            }
+            // the exchange stage is measured on trade prints
+            client_->requirePrints(*symbol);
+            for (uint8_t i = 0; i < (uint8_t)LatencyStage::__count__; ++i)
+            {
+                auto &histogram = (*symbol->latency_)[(LatencyStage)i];
+                info[i].count = (double)histogram.count();
+                info[i].mean_us = histogram.mean() / 1000.;
+                info[i].p50_us = histogram.percentile(0.5) / 1000.;
+                info[i].p90_us = histogram.percentile(0.9) / 1000.;
+                info[i].p99_us = histogram.percentile(0.99) / 1000.;
+                info[i].p999_us = histogram.percentile(0.999) / 1000.;
+                info[i].max_us = histogram.max() / 1000.;
+            }
+            return (double)LatencyStage::__count__;
+        }
+
+        case GET_NOTIFY_STATS:
+        {
+            auto *stats = (NotifyStats*)parameter;
+            if (!stats)
+            {
+                return 0;
+            }
+            stats->updates = (double)client_->notifier().updates();
+            stats->wakeups = (double)client_->notifier().wakeups();
+            return 1;
+        }
+
         case GET_VOLTYPE:
         {
             auto rt = global.price_type_.load(std::memory_order_relaxed) == 2 ? 4 : 3;
@@ -529,9 +932,16 @@ namespace zorro
         }
 
         case SET_VOLTYPE:
+        {
             SPDLOG_TRACE("SET_VOLTYPE: {}", (int)parameter);
+            auto changed = global.vol_type_ != (int)parameter;
             global.vol_type_ = (int)parameter;
+            if (changed && client_)
+            {
+                client_->updateStreams();
+            }
             return parameter;
+        }
 
         case SET_HWND:
         {
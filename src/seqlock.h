@@ -0,0 +1,127 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace zorro {
+
+/**
+ * @brief Single writer sequence lock for small trivially copyable snapshots.
+ *
+ * std::atomic<T> for structs larger than 8/16 bytes is not lock-free and falls back to a hidden
+ * lock shared between the writer and the readers. Here the writer never waits and readers never
+ * block the writer, a reader only retries when it overlaps a store.
+ * The payload is kept in relaxed atomic words so a racing read is well defined, the sequence
+ * number tells the reader whether the words it copied belong to the same store.
+ */
+template<typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock requires a trivially copyable type");
+    static constexpr size_t N = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> seq_{0};
+    std::array<std::atomic<uint64_t>, N> data_{};
+
+public:
+    SeqLock() noexcept { store(T{}); }
+    SeqLock(const T &value) noexcept { store(value); }
+    SeqLock(const SeqLock &other) noexcept { store(other.load()); }
+
+    SeqLock& operator=(const SeqLock &other) noexcept
+    {
+        store(other.load());
+        return *this;
+    }
+
+    /**
+     * @brief Store a new value. Must only be called from a single writer thread.
+     */
+    void store(const T &value) noexcept
+    {
+        std::array<uint64_t, N> buf{};
+        std::memcpy(buf.data(), &value, sizeof(T));
+
+        auto seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);     // odd, write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < N; ++i)
+        {
+            data_[i].store(buf[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Apply fn to a copy of the current value and publish the result. Single writer only.
+     */
+    template<typename Fn>
+    T update(Fn &&fn) noexcept
+    {
+        T value = load();
+        fn(value);
+        store(value);
+        return value;
+    }
+
+    T load() const noexcept
+    {
+        uint64_t seq;
+        return load(seq);
+    }
+
+    /**
+     * @brief Read a consistent copy, also returns the sequence number the copy belongs to.
+     */
+    T load(uint64_t &seq) const noexcept
+    {
+        std::array<uint64_t, N> buf;
+        uint64_t seq1;
+        do
+        {
+            seq = seq_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < N; ++i)
+            {
+                buf[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq1 = seq_.load(std::memory_order_relaxed);
+        } while ((seq & 1) || seq != seq1);
+
+        // T is trivially copyable but may have default member initializers, which g++ flags for memcpy
+        T value;
+        std::memcpy(static_cast<void*>(&value), buf.data(), sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Current sequence number. Even when no store is in progress, increases by 2 per store.
+     */
+    uint64_t sequence() const noexcept { return seq_.load(std::memory_order_acquire); }
+};
+
+}   // namespace zorro
@@ -0,0 +1,104 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+namespace zorro {
+
+/**
+ * @brief Bounded single producer, single consumer queue.
+ *
+ * Each side caches the other side's index and only reloads it when the queue looks full (producer)
+ * or empty (consumer), so an uncontended push or pop touches no shared cache line but its own.
+ */
+template<typename T, uint32_t N>
+class SpscQueue
+{
+    static_assert((N & (N - 1)) == 0, "SpscQueue size must be a power of 2");
+    static_assert(std::is_trivially_copyable_v<T>, "SpscQueue requires a trivially copyable type");
+    static constexpr uint64_t MASK = N - 1;
+
+    alignas(64) std::atomic<uint64_t> head_{0};     // next slot to read, written by the consumer
+    alignas(64) uint64_t cached_tail_ = 0;          // consumer's copy of tail_
+    alignas(64) std::atomic<uint64_t> tail_{0};     // next slot to write, written by the producer
+    alignas(64) uint64_t cached_head_ = 0;          // producer's copy of head_
+    alignas(64) std::array<T, N> slots_;
+
+public:
+    /**
+     * @brief Producer only.
+     * @return false if the queue is full
+     */
+    bool tryPush(const T &value) noexcept
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ >= N)
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ >= N)
+            {
+                return false;
+            }
+        }
+        slots_[tail & MASK] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer only. Calls fn for up to max queued values in order.
+     * @return number of values consumed
+     */
+    template<typename Fn>
+    uint32_t consume(Fn &&fn, uint32_t max = N)
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_)
+            {
+                return 0;
+            }
+        }
+
+        auto n = (uint32_t)std::min<uint64_t>(cached_tail_ - head, max);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            fn(slots_[(head + i) & MASK]);
+        }
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+};
+
+}   // namespace zorro
@@ -27,6 +27,13 @@
 #include <atomic>
 #include <array>
 #include <bitset>
+#include <memory>
+#include "pnl.h"
+#include "seqlock.h"
+#include "order_book.h"
+#include "ring_buffer.h"
+#include "bar_builder.h"
+#include "latency.h"
 
 namespace zorro {
 
@@ -50,6 +57,8 @@ struct Spec
     int32_t size_multiplier_precision_ = 0;
     int64_t min_size_increment_ = 0;
     bool tradable_ = false;
+    uint64_t ref_time_ = 0;     // seconds since epoch when the reference data was received, 0 if unknown
+    bool ref_valid_ = false;    // reference data and price increment received without error or cached, PIPCost relies on it
 };
 
 struct MDTop
@@ -58,6 +67,16 @@ struct MDTop
     double ask_price_ = NAN;
     int64_t bid_qty_ = 0;
     int64_t ask_qty_ = 0;
+    double mid_price_ = NAN;    // derived on every update, NaN until both sides are known
+    double micro_price_ = NAN;  // size weighted mid, leans towards the side with less size
+    uint64_t update_seq_ = 0;   // global market data sequence of the update that produced this top
+
+    void derive() noexcept
+    {
+        mid_price_ = (bid_price_ + ask_price_) * 0.5;
+        auto size = bid_qty_ + ask_qty_;
+        micro_price_ = size > 0 ? (bid_price_ * ask_qty_ + ask_price_ * bid_qty_) / (double)size : mid_price_;
+    }
 };
 
 struct Trade
@@ -68,6 +87,39 @@ struct Trade
     uint64_t time_ = 0;
     uint64_t buy_volume_ = 0;   // total daily buy volume
     uint64_t sell_volume_ = 0;   // total daily sell volume
+    uint64_t update_seq_ = 0;    // global market data sequence of the print
+};
+
+// time and sales of a symbol, every print received by TradePrint
+using TradeHistory = SeqRing<Trade, 4096>;
+
+// incremental session analytics, updated with every print by the market data writer
+struct SessionStats
+{
+    double pv_ = 0.;            // sum of price * size
+    double high_ = NAN;
+    double low_ = NAN;
+    uint64_t volume_ = 0;
+    uint64_t trades_ = 0;
+    uint64_t buy_volume_ = 0;   // prints with a buy aggressor
+    uint64_t sell_volume_ = 0;  // prints with a sell aggressor
+    uint64_t daily_volume_ = 0; // last exchange daily volume, a decrease starts a new session
+    uint64_t start_time_ = 0;   // ns, first print of the session
+
+    double vwap() const noexcept { return volume_ ? pv_ / (double)volume_ : NAN; }
+    int64_t delta() const noexcept { return (int64_t)buy_volume_ - (int64_t)sell_volume_; }
+};
+
+// session statistics streams, only subscribed with RithmicDailyStats or SET_DAILY_STATS
+struct DailyStats
+{
+    double open_ = NAN;
+    double high_ = NAN;
+    double low_ = NAN;
+    double close_ = NAN;
+    double settlement_ = NAN;
+    int64_t open_interest_ = -1;    // -1 unknown
+    uint64_t time_ = 0;             // ns, last update received
 };
 
 struct MDStatus
@@ -80,39 +132,162 @@ enum MDReady : uint8_t
 {
     Top,
     Status,
+    RefData,
     __count__,  // number of MDReady, internal use only
 };
 
 inline const char* to_string(MDReady ready)
 {
-    static constexpr std::array<const char*, 2> ready_str = {"Top", "Status"};
+    static constexpr std::array<const char*, 3> ready_str = {"Top", "Status", "RefData"};
     static_assert(ready_str.size() == MDReady::__count__, "Invalid MDReady");
     return ready_str[(uint8_t)ready];
 }
 
+enum RefPending : uint8_t
+{
+    rp_RefData = 1,
+    rp_PriceIncr = 2,
+};
+
 struct Symbol
 {
     Spec spec_;
+    uint32_t handle_ = 0;   // index into RithmicClient::symbols_, also used as the RApi subscription context
     std::atomic_bool can_trade_;
-    std::atomic<MDTop> top_;
-    std::atomic<Trade> last_trade_;
+    SeqLock<MDTop> top_;            // written by a single thread, the RApi callback or the ingress thread
+    SeqLock<Trade> last_trade_;     // written by a single thread, the RApi callback or the ingress thread
+    SeqLock<SessionStats> session_; // written by a single thread, the RApi callback or the ingress thread
+    SeqLock<DailyStats> daily_;     // written by a single thread, the RApi callback or the ingress thread
+    std::atomic<Position> position_;
     std::atomic<std::bitset<3>> ready_;
+    uint64_t subscribe_time_ = 0;           // ms, set when the subscription is sent
+    std::atomic<uint64_t> ready_time_{0};   // ms, set when all MDReady flags are received
+    std::atomic<uint8_t> ref_pending_{0};   // RefPending bits of the outstanding reference data requests, Zorro thread only
+    uint8_t ref_failed_ = 0;                // RefPending bits of the requests answered with an error, Zorro thread only
+    std::unique_ptr<OrderBook> book_;   // only allocated when market depth is subscribed, not copied
+    std::unique_ptr<TradeHistory> trades_;  // allocated on subscription, not copied
+    std::unique_ptr<LatencyStats> latency_; // allocated on subscription, not copied
+
+    // subscription state, managed by the Zorro thread (client_subscription.cpp)
+    std::atomic_bool subscribed_{false};
+    int subscribe_flags_ = 0;
+    bool prints_used_ = false;      // a broker command read the prints of this symbol, keeps MD_PRINTS subscribed
+    uint32_t ref_count_ = 0;
+    uint64_t last_used_ = 0;        // ms, last BrokerAsset or subscribe call
+    uint64_t subscribed_ms_ = 0;    // time spent subscribed before the current subscription
+    std::atomic<uint64_t> updates_{0};  // market data events applied, single writer
+    std::atomic<uint64_t> prints_{0};   // trade prints applied, single writer
+    uint64_t prints_ms_ = 0;        // time spent subscribed with MD_PRINTS before the current subscription
+    uint64_t trimmed_ms_ = 0;       // time spent subscribed without MD_PRINTS before the current subscription
+
+    // staleness watchdog, see RithmicClient::checkStale
+    std::atomic<uint64_t> last_update_ms_{0};   // receive time of the last market data event, single writer
+    std::atomic_bool stale_{false};             // set by the watchdog, cleared by the next market data event
+    uint64_t watch_deadline_ = 0;   // ms, deadline of the current watchdog timer, Zorro thread only
+    uint64_t stale_backoff_ms_ = 0; // delay before the next resubscribe of a symbol that stays stale
+    uint32_t stale_count_ = 0;      // times the symbol was found stale
+
+    // live bars, one builder per bar period requested by BrokerHistory2, not copied
+    static constexpr uint32_t MAX_BAR_BUILDERS = 4;
+    std::array<std::unique_ptr<BarBuilder>, MAX_BAR_BUILDERS> bar_builders_;
+    std::atomic_uint32_t n_bar_builders_{0};
 
     Symbol() = default;
 
+    /**
+     * @brief Quotes and market status received. Reference data is tracked by the RefData flag on its own,
+     * until it arrives the asset list values are used.
+     */
+    bool isReady() const noexcept
+    {
+        auto ready = ready_.load(std::memory_order_acquire);
+        return ready.test(MDReady::Top) && ready.test(MDReady::Status);
+    }
+
+    bool hasRefData() const noexcept { return ready_.load(std::memory_order_acquire).test(MDReady::RefData); }
+
+    /**
+     * @brief The trade prints stopped or may have been lost, the live bars stop covering until they start over.
+     * Any thread.
+     */
+    void interruptBars() noexcept
+    {
+        auto n = n_bar_builders_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            bar_builders_[i]->interrupt();
+        }
+    }
+
     Symbol(const Symbol &other)
         : spec_(other.spec_)
+        , handle_(other.handle_)
         , can_trade_{other.can_trade_.load(std::memory_order_relaxed)}
-        , top_{other.top_.load(std::memory_order_relaxed)}
+        , top_{other.top_}
+        , last_trade_{other.last_trade_}
+        , session_{other.session_}
+        , daily_{other.daily_}
+        , position_{other.position_.load(std::memory_order_relaxed)}
         , ready_{other.ready_.load(std::memory_order_relaxed)}
+        , subscribe_time_(other.subscribe_time_)
+        , ready_time_{other.ready_time_.load(std::memory_order_relaxed)}
+        , ref_pending_{other.ref_pending_.load(std::memory_order_relaxed)}
+        , ref_failed_(other.ref_failed_)
+        , subscribed_{other.subscribed_.load(std::memory_order_relaxed)}
+        , subscribe_flags_(other.subscribe_flags_)
+        , prints_used_(other.prints_used_)
+        , ref_count_(other.ref_count_)
+        , last_used_(other.last_used_)
+        , subscribed_ms_(other.subscribed_ms_)
+        , updates_{other.updates_.load(std::memory_order_relaxed)}
+        , prints_{other.prints_.load(std::memory_order_relaxed)}
+        , prints_ms_(other.prints_ms_)
+        , trimmed_ms_(other.trimmed_ms_)
+        , last_update_ms_{other.last_update_ms_.load(std::memory_order_relaxed)}
+        , stale_{other.stale_.load(std::memory_order_relaxed)}
+        , watch_deadline_(other.watch_deadline_)
+        , stale_backoff_ms_(other.stale_backoff_ms_)
+        , stale_count_(other.stale_count_)
     {}
 
     Symbol& operator=(const Symbol &other)
     {
         spec_ = other.spec_;
+        handle_ = other.handle_;
         can_trade_.store(other.can_trade_.load(std::memory_order_relaxed));
-        top_.store(other.top_.load(std::memory_order_relaxed));
+        top_ = other.top_;
+        last_trade_ = other.last_trade_;
+        session_ = other.session_;
+        daily_ = other.daily_;
+        position_.store(other.position_.load(std::memory_order_relaxed));
         ready_.store(other.ready_.load(std::memory_order_relaxed));
+        subscribe_time_ = other.subscribe_time_;
+        ready_time_.store(other.ready_time_.load(std::memory_order_relaxed));
+        ref_pending_.store(other.ref_pending_.load(std::memory_order_relaxed));
+        ref_failed_ = other.ref_failed_;
+        subscribed_.store(other.subscribed_.load(std::memory_order_relaxed));
+        subscribe_flags_ = other.subscribe_flags_;
+        prints_used_ = other.prints_used_;
+        ref_count_ = other.ref_count_;
+        last_used_ = other.last_used_;
+        subscribed_ms_ = other.subscribed_ms_;
+        updates_.store(other.updates_.load(std::memory_order_relaxed));
+        prints_.store(other.prints_.load(std::memory_order_relaxed));
+        prints_ms_ = other.prints_ms_;
+        trimmed_ms_ = other.trimmed_ms_;
+        last_update_ms_.store(other.last_update_ms_.load(std::memory_order_relaxed));
+        stale_.store(other.stale_.load(std::memory_order_relaxed));
+        watch_deadline_ = other.watch_deadline_;
+        stale_backoff_ms_ = other.stale_backoff_ms_;
+        stale_count_ = other.stale_count_;
+        book_.reset();
+        trades_.reset();
+        latency_.reset();
+        n_bar_builders_.store(0, std::memory_order_relaxed);
+        for (auto &builder : bar_builders_)
+        {
+            builder.reset();
+        }
         return *this;
     }
 };
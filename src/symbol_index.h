@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace zorro {
+
+/**
+ * @brief Asset name to symbol handle index that any thread can search.
+ *
+ * Open addressing over a fixed table of at least twice N slots, so a probe sequence stays short and no
+ * resize ever moves a slot under a reader. Each slot packs a 32 bit tag of the name hash with handle + 1,
+ * a reader only compares names when the hash tag matches. Single writer (the Zorro thread), which inserts
+ * a handle before publishing it. Entries are never removed, the name of a published symbol never changes.
+ */
+template<uint32_t N>
+class SymbolIndex
+{
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+private:
+    static constexpr uint32_t CAPACITY = std::bit_ceil(N * 2);
+    static constexpr uint32_t MASK = CAPACITY - 1;
+    static constexpr int SHIFT = 64 - std::countr_zero(CAPACITY);
+
+    std::array<std::atomic<uint64_t>, CAPACITY> slots_{};    // tag << 32 | (handle + 1), 0 if empty
+
+    // size_t is 32 bits in the plugin build, spread the hash over the table with a multiplicative step
+    static uint64_t hash(std::string_view name) noexcept { return std::hash<std::string_view>{}(name); }
+    static uint64_t tag(uint64_t h) noexcept { return (h ^ (h >> 32)) << 32; }
+    static uint32_t home(uint64_t h) noexcept { return (uint32_t)((h * 0x9E3779B97F4A7C15ull) >> SHIFT); }
+
+public:
+    void insert(std::string_view name, uint32_t handle) noexcept
+    {
+        auto h = hash(name);
+        auto entry = tag(h) | (handle + 1);
+        for (auto i = home(h); ; i = (i + 1) & MASK)
+        {
+            if (!slots_[i].load(std::memory_order_relaxed))
+            {
+                // the name of the slot is written before, readers acquire the entry
+                slots_[i].store(entry, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Handle of name or INVALID. name_of(handle) returns the name the handle was inserted with.
+     */
+    template<typename NameOf>
+    uint32_t find(std::string_view name, NameOf &&name_of) const noexcept
+    {
+        auto h = hash(name);
+        auto t = tag(h);
+        for (auto i = home(h); ; i = (i + 1) & MASK)
+        {
+            auto entry = slots_[i].load(std::memory_order_acquire);
+            if (!entry)
+            {
+                return INVALID;
+            }
+            auto handle = (uint32_t)entry - 1;
+            if ((entry & 0xFFFFFFFF00000000ull) == t && name_of(handle) == name)
+            {
+                return handle;
+            }
+        }
+    }
+};
+
+}   // namespace zorro
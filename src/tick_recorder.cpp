@@ -0,0 +1,260 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "stdafx.h"
+#include "tick_recorder.h"
+#include <date/date.h>
+
+using namespace zorro;
+
+bool MappedTickFile::map(size_t capacity)
+{
+    unmap();
+    ULARGE_INTEGER size;
+    size.QuadPart = capacity * record_size_;
+    // a mapping larger than the file extends the file
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+    if (!mapping_)
+    {
+        SPDLOG_ERROR("CreateFileMapping {} failed. err: {}", path_, GetLastError());
+        return false;
+    }
+    view_ = static_cast<uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, (SIZE_T)size.QuadPart));
+    if (!view_)
+    {
+        SPDLOG_ERROR("MapViewOfFile {} failed. err: {}", path_, GetLastError());
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+        return false;
+    }
+    capacity_ = capacity;
+    return true;
+}
+
+void MappedTickFile::unmap()
+{
+    if (view_)
+    {
+        UnmapViewOfFile(view_);
+        view_ = nullptr;
+    }
+    if (mapping_)
+    {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+}
+
+void MappedTickFile::reverse()
+{
+    uint8_t tmp[32];
+    for (size_t i = 0, j = n_records_ - 1; n_records_ && i < j; ++i, --j)
+    {
+        auto *a = view_ + i * record_size_;
+        auto *b = view_ + j * record_size_;
+        memcpy(tmp, a, record_size_);
+        memcpy(a, b, record_size_);
+        memcpy(b, tmp, record_size_);
+    }
+}
+
+bool MappedTickFile::open(const std::string &path, size_t record_size, int32_t day)
+{
+    path_ = path;
+    record_size_ = record_size;
+    day_ = day;
+    file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+    {
+        SPDLOG_ERROR("Failed to open {}. err: {}", path, GetLastError());
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file_, &file_size);
+    n_records_ = (size_t)file_size.QuadPart / record_size_;
+    auto segment = SEGMENT_BYTES / record_size_;
+    if (!map((n_records_ / segment + 1) * segment))
+    {
+        close();
+        return false;
+    }
+
+    // a file that was not closed properly is still ascending with zero records preallocated at the end
+    while (n_records_ && *reinterpret_cast<DATE*>(view_ + (n_records_ - 1) * record_size_) == 0.)
+    {
+        --n_records_;
+    }
+    if (n_records_ > 1 && *reinterpret_cast<DATE*>(view_) > *reinterpret_cast<DATE*>(view_ + (n_records_ - 1) * record_size_))
+    {
+        reverse();
+    }
+    flushed_ = 0;
+    return true;
+}
+
+bool MappedTickFile::append(const void *record)
+{
+    if (!view_)
+    {
+        return false;
+    }
+    if (n_records_ == capacity_ && !map(capacity_ + SEGMENT_BYTES / record_size_))
+    {
+        return false;
+    }
+    memcpy(view_ + n_records_ * record_size_, record, record_size_);
+    ++n_records_;
+    return true;
+}
+
+void MappedTickFile::flush()
+{
+    if (view_ && n_records_ > flushed_)
+    {
+        FlushViewOfFile(view_ + flushed_ * record_size_, (n_records_ - flushed_) * record_size_);
+        flushed_ = n_records_;
+    }
+}
+
+void MappedTickFile::close()
+{
+    if (file_ == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    if (view_)
+    {
+        reverse();      // Zorro history files are newest first
+        FlushViewOfFile(view_, 0);
+    }
+    unmap();
+
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)(n_records_ * record_size_);
+    SetFilePointerEx(file_, end, nullptr, FILE_BEGIN);
+    SetEndOfFile(file_);
+    CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+    SPDLOG_INFO("{} closed, {} ticks", path_, n_records_);
+}
+
+TickRecorder::TickRecorder(std::string dir, std::function<std::string(uint32_t)> asset_name)
+    : dir_(std::move(dir))
+    , asset_name_(std::move(asset_name))
+    , queue_(std::make_unique<SpscQueue<Record, 65536>>())
+{
+}
+
+TickRecorder::~TickRecorder()
+{
+    stop();
+}
+
+void TickRecorder::start()
+{
+    if (running_.exchange(true, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    CreateDirectoryA(dir_.c_str(), nullptr);
+    thread_ = std::thread([this]() { run(); });
+    SPDLOG_INFO("Recording ticks to {}", dir_);
+}
+
+void TickRecorder::stop()
+{
+    if (!running_.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    SPDLOG_INFO("Tick recorder: {} ticks recorded, {} dropped, {} files", records(), dropped(), filesOpened());
+}
+
+void TickRecorder::run()
+{
+    auto last_flush = GetTickCount64();
+    while (running_.load(std::memory_order_acquire))
+    {
+        auto n = queue_->consume([this](const Record &record) { write(record); }, 4096);
+
+        auto now = GetTickCount64();
+        if (now - last_flush >= 1000)
+        {
+            for (auto &[key, file] : files_)
+            {
+                file->flush();
+            }
+            last_flush = now;
+        }
+
+        if (!n)
+        {
+            Sleep(1);
+        }
+    }
+
+    queue_->consume([this](const Record &record) { write(record); });
+    files_.clear();
+}
+
+void TickRecorder::write(const Record &record)
+{
+    auto day = (int32_t)record.time_;
+    auto &file = files_[((uint64_t)record.handle_ << 8) | (uint8_t)record.type_];
+    if (!file || file->day_ != day)
+    {
+        // first tick of the asset or a new UTC day
+        file = std::make_unique<MappedTickFile>();
+        auto ymd = date::format("%Y%m%d", date::sys_days{date::days{day - 25569}});
+        auto path = std::format("{}\\{}_{}.{}", dir_, asset_name_(record.handle_), ymd, record.type_ == Type::T1 ? "t1" : "t2");
+        if (file->open(path, record.type_ == Type::T1 ? sizeof(T1) : sizeof(T2), day))
+        {
+            files_opened_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool ok;
+    if (record.type_ == Type::T1)
+    {
+        T1 tick{record.time_, record.val_};
+        ok = file->append(&tick);
+    }
+    else
+    {
+        T2 tick{record.time_, record.val_, record.vol_};
+        ok = file->append(&tick);
+    }
+
+    if (ok)
+    {
+        records_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,144 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include "spsc_queue.h"
+
+typedef double DATE;
+#include <include\trading.h>
+
+namespace zorro {
+
+/**
+ * @brief A .t1 or .t2 file written through a growing memory mapping.
+ *
+ * Records are appended in ascending time order. The mapping is preallocated SEGMENT_BYTES at a
+ * time, close() reverses the records into Zorro's descending order and cuts the file to its size.
+ */
+class MappedTickFile
+{
+    static constexpr size_t SEGMENT_BYTES = 4 * 1024 * 1024;
+
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+    uint8_t *view_ = nullptr;
+    size_t record_size_ = 0;
+    size_t n_records_ = 0;
+    size_t capacity_ = 0;       // records
+    size_t flushed_ = 0;        // records
+    std::string path_;
+
+    bool map(size_t capacity);
+    void unmap();
+    void reverse();
+
+public:
+    int32_t day_ = 0;
+
+    MappedTickFile() = default;
+    ~MappedTickFile() { close(); }
+    MappedTickFile(const MappedTickFile&) = delete;
+    MappedTickFile& operator=(const MappedTickFile&) = delete;
+
+    /**
+     * @brief Open or continue a file. The records of an existing file are turned back into ascending order.
+     */
+    bool open(const std::string &path, size_t record_size, int32_t day);
+    bool append(const void *record);
+    void flush();
+    void close();
+    size_t size() const noexcept { return n_records_; }
+};
+
+/**
+ * @brief Records live ticks into daily Zorro .t1 (trades) and .t2 (bid/ask) files.
+ *
+ * The market data thread only pushes a small record into a SPSC queue. Mapping, growing,
+ * flushing and rolling the files is done by the recorder thread. A full queue drops the record
+ * instead of blocking market data.
+ */
+class TickRecorder
+{
+public:
+    enum class Type : uint8_t
+    {
+        T1,
+        T2,
+    };
+
+    struct Record
+    {
+        DATE time_;
+        float val_;         // price, negative for bid
+        float vol_;         // T2 only
+        uint32_t handle_;
+        Type type_;
+    };
+
+private:
+    std::string dir_;
+    std::function<std::string(uint32_t)> asset_name_;
+    std::unique_ptr<SpscQueue<Record, 65536>> queue_;
+    std::unordered_map<uint64_t, std::unique_ptr<MappedTickFile>> files_;   // recorder thread only
+    std::atomic_bool running_{false};
+    std::thread thread_;
+
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> files_opened_{0};
+
+    void run();
+    void write(const Record &record);
+
+public:
+    TickRecorder(std::string dir, std::function<std::string(uint32_t)> asset_name);
+    ~TickRecorder();
+
+    void start();
+    void stop();
+
+    /**
+     * @brief Single producer, called by the thread that publishes market data.
+     */
+    void record(uint32_t handle, Type type, DATE time, float val, float vol = 0.f) noexcept
+    {
+        if (!queue_->tryPush(Record{time, val, vol, handle, type}))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t records() const noexcept { return records_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t filesOpened() const noexcept { return files_opened_.load(std::memory_order_relaxed); }
+};
+
+}   // namespace zorro
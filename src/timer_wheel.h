@@ -0,0 +1,111 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace zorro {
+
+/**
+ * @brief Hashed timer wheel for many coarse, mostly rescheduled deadlines.
+ *
+ * N slots of TickMs each. Scheduling is O(1), a deadline beyond one revolution stays in its slot
+ * until the wheel comes around again. Not thread safe, driven by a single thread.
+ */
+template<uint32_t N, uint32_t TickMs>
+class TimerWheel
+{
+    static_assert(N && (N & (N - 1)) == 0, "TimerWheel size must be a power of 2");
+
+    struct Entry
+    {
+        uint32_t id_;
+        uint64_t deadline_;     // ms
+    };
+
+    std::array<std::vector<Entry>, N> slots_;
+    std::vector<Entry> expired_;
+    static constexpr uint64_t NOT_STARTED = UINT64_MAX;
+    uint64_t tick_ = NOT_STARTED;       // next tick to process
+    uint64_t first_tick_ = NOT_STARTED; // earliest tick scheduled before the first advance
+
+public:
+    void schedule(uint32_t id, uint64_t deadline_ms)
+    {
+        auto tick = deadline_ms / TickMs;
+        if (tick_ == NOT_STARTED)
+        {
+            first_tick_ = std::min(first_tick_, tick);
+        }
+        else if (tick < tick_)
+        {
+            tick = tick_;
+        }
+        slots_[tick & (N - 1)].push_back(Entry{id, deadline_ms});
+    }
+
+    /**
+     * @brief Process all ticks up to now and call fn(id, deadline) for every expired entry.
+     * fn may schedule again.
+     */
+    template<typename Fn>
+    void advance(uint64_t now_ms, Fn &&fn)
+    {
+        auto now_tick = now_ms / TickMs;
+        if (tick_ == NOT_STARTED)
+        {
+            tick_ = std::min(first_tick_, now_tick);
+        }
+        // after a long pause one revolution visits every slot
+        auto n = tick_ > now_tick ? 0 : std::min<uint64_t>(now_tick + 1 - tick_, N);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            auto &slot = slots_[(tick_ + i) & (N - 1)];
+            for (size_t j = 0; j < slot.size();)
+            {
+                if (slot[j].deadline_ <= now_ms)
+                {
+                    expired_.push_back(slot[j]);
+                    slot[j] = slot.back();
+                    slot.pop_back();
+                }
+                else
+                {
+                    ++j;
+                }
+            }
+        }
+        tick_ = std::max(tick_, now_tick + 1);
+
+        // callbacks run after the scan so rescheduled entries are not visited twice
+        for (auto &entry : expired_)
+        {
+            fn(entry.id_, entry.deadline_);
+        }
+        expired_.clear();
+    }
+};
+
+}   // namespace zorro
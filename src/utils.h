@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include <RApiPlus.h>
@@ -46,12 +48,41 @@ inline std::string_view to_string_view(const tsNCharcb &nchar)
     return std::string_view(nchar.pData, nchar.iDataLen);
 }
 
+/**
+ * @brief Copy an RApi string into a fixed size, null terminated buffer of an Order. Truncates.
+ */
+template<size_t N>
+inline void copyId(char (&dst)[N], const tsNCharcb &src) noexcept
+{
+    size_t len = src.pData && src.iDataLen > 0 ? std::min((size_t)src.iDataLen, N - 1) : 0;
+    if (len)
+    {
+        std::memcpy(dst, src.pData, len);
+    }
+    dst[len] = 0;
+}
+
 template<typename infoT>
 inline std::string symbol(const infoT *info)
 {
     return std::format("{}.{}", to_string_view(info->sTicker), to_string_view(info->sExchange));
 }
 
+// Format "TICKER.EXCH" into a caller provided buffer, no allocation.
+template<typename infoT, size_t N>
+inline std::string_view symbol(const infoT *info, char (&buf)[N])
+{
+    auto result = std::format_to_n(buf, N, "{}.{}", to_string_view(info->sTicker), to_string_view(info->sExchange));
+    return std::string_view(buf, result.out);
+}
+
+// Transparent hash so maps keyed by std::string can be searched with a string_view
+struct StringHash
+{
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+
 inline DATE convertTime(__time32_t t32)
 {
     return (DATE)t32 / 86400. + 25569.; // 25569. = DATE(1.1.1970 00:00)
@@ -72,6 +103,23 @@ inline uint64_t get_timestamp()
     return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
 }
 
+inline DATE nanosec_to_date(uint64_t ns)
+{
+    return (DATE)(ns / 1000000) / 86400000. + 25569.;
+}
+
+// ns since epoch, for latency measurements against exchange timestamps
+inline uint64_t get_timestamp_ns()
+{
+    auto now = std::chrono::system_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+}
+
+inline DATE get_date()
+{
+    return (DATE)get_timestamp() / 86400000. + 25569.;
+}
+
 template<typename T>
 inline uint64_t nanosec(const T &info)
 {
@@ -0,0 +1,185 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace zorro {
+
+extern int(__cdecl* BrokerProgress)(const int percent);
+
+enum class WaitSite : uint8_t
+{
+    Request,        // waitForRequest
+    SendOrder,
+    CancelOrder,
+    RetrieveOrder,
+    Asset,          // BrokerAsset waiting for the first quote
+    Login,
+    Subscribe,      // bulk subscription readiness
+    __count__,      // number of WaitSite, internal use only
+};
+
+inline const char* to_string(WaitSite site)
+{
+    static constexpr std::array<const char*, 7> site_str = {"Request", "SendOrder", "CancelOrder", "RetrieveOrder", "Asset", "Login", "Subscribe"};
+    static_assert(site_str.size() == (size_t)WaitSite::__count__, "Invalid WaitSite");
+    return site_str[(uint8_t)site];
+}
+
+enum class WaitResult : uint8_t
+{
+    Done,
+    Aborted,    // BrokerProgress returned 0
+    Timeout,
+};
+
+/**
+ * @brief Waits on the Zorro thread for a condition set by a RApi callback.
+ *
+ * The wait spins for spin_count iterations, then yields the CPU for yield_count iterations and
+ * finally blocks on an epoch counter for at most block_ms at a time. Callbacks call signal() after
+ * they publish the result, which wakes every blocked waiter so concurrent waits on different orders
+ * all recheck their own condition. A missed signal only costs one block_ms timeout. BrokerProgress
+ * is called in the yield and block phases so Zorro stays responsive and can abort the wait.
+ */
+class Waiter
+{
+public:
+    struct Stats
+    {
+        std::atomic<uint64_t> calls_{0};
+        std::atomic<uint64_t> blocked_{0};      // waits that reached the block phase
+        std::atomic<uint64_t> wait_us_{0};
+        std::atomic<uint64_t> max_wait_us_{0};
+        std::atomic<uint64_t> cpu_us_{0};       // user + kernel time of the waiting thread
+    };
+
+private:
+    std::atomic<uint32_t> epoch_{0};
+    uint32_t spin_count_ = 2000;
+    uint32_t yield_count_ = 100;
+    uint32_t block_ms_ = 1;
+    std::array<Stats, (size_t)WaitSite::__count__> stats_;
+
+    static uint64_t threadCpuTimeUs() noexcept
+    {
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        {
+            return 0;
+        }
+        auto to_us = [](const FILETIME &ft) { return ((uint64_t(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) / 10; };
+        return to_us(kernel) + to_us(user);
+    }
+
+public:
+    Waiter() = default;
+
+    Waiter(const Waiter&) = delete;
+    Waiter& operator=(const Waiter&) = delete;
+
+    void configure(uint32_t spin_count, uint32_t yield_count, uint32_t block_ms) noexcept
+    {
+        spin_count_ = spin_count;
+        yield_count_ = yield_count;
+        block_ms_ = block_ms ? block_ms : 1;
+    }
+
+    /**
+     * @brief Wake up all waiting threads. Called by the RApi thread after the result is published.
+     */
+    void signal() noexcept
+    {
+        epoch_.fetch_add(1, std::memory_order_release);
+        WakeByAddressAll(&epoch_);
+    }
+
+    /**
+     * @brief Wait until done() returns true.
+     * @param timeout_ms 0 = no timeout
+     */
+    template<typename Pred>
+    WaitResult wait(WaitSite site, Pred &&done, uint64_t timeout_ms = 0)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto cpu_start = threadCpuTimeUs();
+        bool blocked = false;
+        auto result = WaitResult::Done;
+
+        for (uint32_t i = 0; i < spin_count_ && !done(); ++i)
+        {
+            YieldProcessor();
+        }
+
+        uint32_t n = 0;
+        while (true)
+        {
+            // read the epoch before the condition so a signal in between is not lost
+            auto epoch = epoch_.load(std::memory_order_acquire);
+            if (done())
+            {
+                break;
+            }
+            if (!BrokerProgress(1))
+            {
+                result = WaitResult::Aborted;
+                break;
+            }
+            if (timeout_ms && std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(timeout_ms))
+            {
+                result = WaitResult::Timeout;
+                break;
+            }
+            if (n < yield_count_)
+            {
+                ++n;
+                SwitchToThread();
+            }
+            else
+            {
+                blocked = true;
+                WaitOnAddress(&epoch_, &epoch, sizeof(epoch), block_ms_);
+            }
+        }
+
+        auto &stats = stats_[(uint8_t)site];
+        auto wait_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        stats.calls_.fetch_add(1, std::memory_order_relaxed);
+        stats.blocked_.fetch_add(blocked, std::memory_order_relaxed);
+        stats.wait_us_.fetch_add(wait_us, std::memory_order_relaxed);
+        stats.cpu_us_.fetch_add(threadCpuTimeUs() - cpu_start, std::memory_order_relaxed);
+        if (wait_us > stats.max_wait_us_.load(std::memory_order_relaxed))
+        {
+            stats.max_wait_us_.store(wait_us, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    const Stats& stats(WaitSite site) const noexcept { return stats_[(uint8_t)site]; }
+};
+
+}   // namespace zorro
@@ -0,0 +1,135 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Live bar coverage across an interrupted print stream. Bars built before the interruption must not be
+// served as complete once prints may have been lost, and coverage resumes after the first partial bar
+// following the interruption. Interruptions from another thread while prints arrive must never let the
+// coverage go back to a bar from before the last interruption.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <windows.h>    // before trading.h, included by bar_builder.h
+#include "bar_builder.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint64_t SEC = 1000000000;
+constexpr int64_t T0 = 1699999980;      // seconds, a multiple of 60
+constexpr int MAX_COPY = 64;
+
+// a print every 10 seconds in [from, to)
+void feed(BarBuilder &builder, int64_t from, int64_t to)
+{
+    for (auto t = from; t < to; t += 10)
+    {
+        builder.onTrade((uint64_t)t * SEC, 100. + (double)(t % 7), 1);
+    }
+}
+
+int64_t endOf(const T6 &tick)
+{
+    return (int64_t)((tick.time - 25569.) * 86400. + 0.5);
+}
+
+void interruptedStream()
+{
+    BarBuilder builder(1);
+    T6 bars[MAX_COPY];
+    CHECK(builder.coveredFrom() == INT64_MAX);
+
+    // the first bar is partial, coverage starts with its end
+    feed(builder, T0 + 30, T0 + 600);
+    auto covered = builder.coveredFrom();
+    CHECK(covered == T0 + 60);
+    auto n = builder.copy(T0, T0 + 600, T0 + 600, MAX_COPY, bars);
+    CHECK(n == 9);
+    CHECK(endOf(bars[0]) == T0 + 600 && endOf(bars[n - 1]) == T0 + 120);
+
+    // unsubscribed, nothing is covered until the prints start over
+    builder.interrupt();
+    CHECK(builder.coveredFrom() == INT64_MAX);
+    CHECK(builder.copy(T0, T0 + 600, T0 + 600, MAX_COPY, bars) == 0);
+
+    // resubscribed 5 minutes later in the middle of a bar
+    feed(builder, T0 + 905, T0 + 1200);
+    CHECK(builder.coveredFrom() == T0 + 960);
+    CHECK(builder.coveredFrom() > covered);
+    n = builder.copy(T0, T0 + 1200, T0 + 1200, MAX_COPY, bars);
+    CHECK(n == 4);
+    for (int i = 0; i < n; ++i)
+    {
+        CHECK(endOf(bars[i]) > T0 + 960);
+    }
+
+    // an interruption within the bar in progress drops that bar as well
+    builder.interrupt();
+    feed(builder, T0 + 1210, T0 + 1300);
+    CHECK(builder.coveredFrom() == T0 + 1260);
+    n = builder.copy(T0, T0 + 1320, T0 + 1320, MAX_COPY, bars);
+    CHECK(n == 1 && endOf(bars[0]) == T0 + 1320);
+}
+
+void concurrentInterrupts()
+{
+    BarBuilder builder(1);
+    std::atomic_bool done{false};
+    std::atomic<int64_t> interrupted_at{0};     // time of the last print before the latest interrupt
+    std::atomic<int64_t> last_print{0};
+
+    std::thread writer([&]()
+    {
+        for (int64_t t = T0; t < T0 + 2000000; t += 5)
+        {
+            builder.onTrade((uint64_t)t * SEC, 100., 1);
+            last_print.store(t, std::memory_order_release);
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t checks = 0;
+    while (!done.load(std::memory_order_acquire))
+    {
+        if (++checks % 64 == 0)
+        {
+            interrupted_at.store(last_print.load(std::memory_order_acquire), std::memory_order_relaxed);
+            builder.interrupt();
+        }
+        auto covered = builder.coveredFrom();
+        CHECK(covered == INT64_MAX || covered > interrupted_at.load(std::memory_order_relaxed));
+    }
+    writer.join();
+    std::printf("%llu coverage checks with interruptions\n", (unsigned long long)checks);
+}
+
+}   // namespace
+
+int main()
+{
+    interruptedStream();
+    concurrentInterrupts();
+    return 0;
+}
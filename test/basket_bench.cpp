@@ -0,0 +1,206 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Time a basket of orders keeps the Zorro thread in BrokerBuy2, blocking against asynchronous order
+// entry (RithmicAsyncOrders). A scripted stand-in for the exchange acknowledges every order one round
+// trip after it was sent, through the same OrderPool, waitOrder() and completeOrder() as the plugin.
+// The blocking mode waits for each acknowledgement before the next send, the asynchronous mode sends
+// the whole basket and picks the acknowledgements up later, the way BrokerTrade does.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "order_pool.h"
+#include "order_wait.h"
+#include "test_util.h"
+
+namespace zorro {
+int(__cdecl* BrokerProgress)(const int percent) = [](const int) { return 1; };
+}
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint32_t BASKET = 20;
+constexpr uint64_t RTT_NS = 1000000;    // 1 ms to the exchange and back
+
+struct Sent
+{
+    uint32_t handle_;
+    uint64_t ack_at_;
+};
+
+/**
+ * @brief Stand-in for the R|API thread and the exchange, acknowledges the orders in the order they
+ * were sent, each one RTT_NS after its send.
+ */
+class Exchange
+{
+    OrderPool &orders_;
+    Waiter &waiter_;
+    std::mutex mutex_;
+    std::deque<Sent> sent_;
+    std::atomic_bool stop_{false};
+    std::thread thread_;
+    uint32_t next_order_num_ = 1;
+
+public:
+    Exchange(OrderPool &orders, Waiter &waiter) : orders_(orders), waiter_(waiter), thread_([this]() { run(); }) {}
+
+    void stop()
+    {
+        stop_.store(true, std::memory_order_relaxed);
+        thread_.join();
+    }
+
+    // REngine::sendOrder
+    void send(uint32_t handle)
+    {
+        std::lock_guard lock(mutex_);
+        sent_.push_back(Sent{handle, test::nowNs() + RTT_NS});
+    }
+
+private:
+    void run()
+    {
+        while (true)
+        {
+            Sent next{};
+            {
+                std::lock_guard lock(mutex_);
+                if (!sent_.empty())
+                {
+                    next = sent_.front();
+                    sent_.pop_front();
+                }
+            }
+            if (!next.handle_)
+            {
+                if (stop_.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            auto now = test::nowNs();
+            if (next.ack_at_ > now)
+            {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(next.ack_at_ - now));
+            }
+            auto order = orders_.pin(next.handle_);
+            CHECK(order);
+            order->state_.update([this](OrderState &state)
+            {
+                state.order_num_ = next_order_num_++;
+                state.status_ = OrderStatus::Open;
+            });
+            completeOrder(waiter_, order, or_Send);
+        }
+    }
+};
+
+// doSendOrder up to the engine call
+Order* send(OrderPool &orders, Exchange &exchange, bool async)
+{
+    auto *order = orders.allocate();
+    CHECK(order);
+    if (!async)
+    {
+        order->requests_.fetch_or(or_Send, std::memory_order_release);
+    }
+    exchange.send(order->handle_.load(std::memory_order_relaxed));
+    return order;
+}
+
+struct Timing
+{
+    uint64_t submit_ns_ = 0;    // Zorro thread inside BrokerBuy2
+    uint64_t acked_ns_ = 0;     // until every order of the basket is acknowledged
+};
+
+Timing basket(OrderPool &orders, Waiter &waiter, Exchange &exchange, bool async)
+{
+    std::vector<Order*> sent;
+    auto start = test::nowNs();
+    for (uint32_t i = 0; i < BASKET; ++i)
+    {
+        auto *order = send(orders, exchange, async);
+        if (!async)
+        {
+            CHECK(waitOrder(waiter, order, or_Send, WaitSite::SendOrder, 1000) == WaitResult::Done);
+        }
+        sent.push_back(order);
+    }
+    Timing timing;
+    timing.submit_ns_ = test::nowNs() - start;
+
+    // BrokerTrade polling the order state
+    for (auto *order : sent)
+    {
+        CHECK(waiter.wait(WaitSite::Request, [order]() { return order->state_.load().order_num_ != 0; }, 1000) == WaitResult::Done);
+    }
+    timing.acked_ns_ = test::nowNs() - start;
+
+    for (auto *order : sent)
+    {
+        orders.release(order);
+    }
+    return timing;
+}
+
+void run(const char *name, OrderPool &orders, Waiter &waiter, Exchange &exchange, bool async, uint64_t baskets)
+{
+    Timing total;
+    for (uint64_t i = 0; i < baskets; ++i)
+    {
+        auto timing = basket(orders, waiter, exchange, async);
+        total.submit_ns_ += timing.submit_ns_;
+        total.acked_ns_ += timing.acked_ns_;
+    }
+    std::printf("%-20s submit %10.1f us/basket, all acked %10.1f us/basket\n", name,
+        total.submit_ns_ / 1e3 / (double)baskets, total.acked_ns_ / 1e3 / (double)baskets);
+}
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    auto baskets = test::iterations(argc, argv, 50);
+
+    OrderPool orders(100000);
+    Waiter waiter;
+    waiter.configure(200, 20, 1);
+    Exchange exchange(orders, waiter);
+
+    std::printf("%u orders per basket, %.1f ms round trip\n", BASKET, RTT_NS / 1e6);
+    run("blocking", orders, waiter, exchange, false, baskets);
+    run("async", orders, waiter, exchange, true, baskets);
+    exchange.stop();
+    return 0;
+}
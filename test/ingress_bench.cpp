@@ -0,0 +1,196 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Callback return latency with and without RithmicCallbackQueue. Inline, the callback decodes the
+// update and applies it: a top of book seqlock update, a trade ring push for every 4th update and
+// the publish latency record. Queued, it decodes the update and pushes it into the MDQueue, an
+// ingress thread applies it. Events arrive in bursts of 256 and the next burst waits until the
+// previous one is applied, like a feed that is faster than the callbacks only for short periods.
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include "ingress.h"
+#include "latency.h"
+#include "ring_buffer.h"
+#include "seqlock.h"
+#include "test_util.h"
+
+namespace zorro {
+enum class Side : uint8_t { Buy, Sell, Unknown };
+}
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint32_t BURST = 256;
+
+struct Top
+{
+    double bid_;
+    double ask_;
+    int64_t bid_qty_;
+    int64_t ask_qty_;
+    double mid_;
+    double micro_;
+    uint64_t seq_;
+};
+
+struct Print
+{
+    double price_;
+    int64_t qty_;
+    uint64_t time_;
+    uint64_t seq_;
+};
+
+// the state an event is applied to
+struct Book
+{
+    SeqLock<Top> top_;
+    SeqLock<Print> last_;
+    SeqRing<Print, 4096> prints_;
+    LatencyHistogram publish_;
+    uint64_t seq_ = 0;
+
+    void apply(const MDEvent &event) noexcept
+    {
+        ++seq_;
+        if (event.type_ == MDEventType::Trade)
+        {
+            Print print{event.price_[0], event.qty_[0], event.time_, seq_};
+            last_.store(print);
+            prints_.push(print);
+        }
+        else
+        {
+            top_.update([&](Top &top)
+            {
+                top.bid_ = event.price_[0];
+                top.ask_ = event.price_[1];
+                top.bid_qty_ = event.qty_[0];
+                top.ask_qty_ = event.qty_[1];
+                top.mid_ = (top.bid_ + top.ask_) * 0.5;
+                auto size = top.bid_qty_ + top.ask_qty_;
+                top.micro_ = size > 0 ? (top.bid_ * (double)top.ask_qty_ + top.ask_ * (double)top.bid_qty_) / (double)size : top.mid_;
+                top.seq_ = seq_;
+            });
+        }
+        publish_.record(test::nowNs() - event.recv_time_);
+    }
+};
+
+MDEvent decode(uint64_t i) noexcept
+{
+    MDEvent event;
+    event.type_ = i % 4 == 3 ? MDEventType::Trade : MDEventType::Top;
+    event.flags_ = mf_BidPrice | mf_BidSize | mf_AskPrice | mf_AskSize;
+    event.side_ = Side::Buy;
+    event.handle_ = 0;
+    event.time_ = i;
+    event.recv_time_ = test::nowNs();
+    event.price_[0] = 5000. + (double)(i % 8) * 0.25;
+    event.price_[1] = event.price_[0] + 0.25;
+    event.qty_[0] = (int64_t)(i % 50) + 1;
+    event.qty_[1] = (int64_t)(i % 30) + 1;
+    event.volume_[0] = event.volume_[1] = i;
+    return event;
+}
+
+void report(const char *name, const LatencyHistogram &callback, const LatencyHistogram &publish)
+{
+    std::printf("%-8s callback mean %5llu ns, p50 %5llu, p99 %6llu, max %8llu | publish p50 %6llu ns, p99 %8llu\n", name,
+        (unsigned long long)callback.mean(), (unsigned long long)callback.percentile(0.5), (unsigned long long)callback.percentile(0.99),
+        (unsigned long long)callback.max(), (unsigned long long)publish.percentile(0.5), (unsigned long long)publish.percentile(0.99));
+}
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    auto n = test::iterations(argc, argv, 2000000) / BURST * BURST;
+
+    {
+        auto book = std::make_unique<Book>();
+        auto callback = std::make_unique<LatencyHistogram>();
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            auto start = test::nowNs();
+            book->apply(decode(i));
+            callback->record(test::nowNs() - start);
+        }
+        report("inline", *callback, book->publish_);
+    }
+
+    {
+        auto book = std::make_unique<Book>();
+        auto callback = std::make_unique<LatencyHistogram>();
+        auto queue = std::make_unique<MDQueue>();
+        std::atomic<uint64_t> applied{0};
+        std::atomic_bool running{true};
+        std::thread ingress([&]()
+        {
+            while (running.load(std::memory_order_acquire))
+            {
+                auto consumed = queue->consume([&](const MDEvent &event) { book->apply(event); });
+                if (consumed)
+                {
+                    applied.fetch_add(consumed, std::memory_order_release);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint64_t stalls = 0;
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            auto start = test::nowNs();
+            auto event = decode(i);
+            while (!queue->tryPush(event))
+            {
+                ++stalls;
+            }
+            // as RithmicClient::pushIngress, which checks whether the ingress thread sleeps
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            callback->record(test::nowNs() - start);
+
+            if (i % BURST == BURST - 1)
+            {
+                while (applied.load(std::memory_order_acquire) <= i)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        running.store(false, std::memory_order_release);
+        ingress.join();
+        report("queued", *callback, book->publish_);
+        std::printf("queue full %llu times\n", (unsigned long long)stalls);
+    }
+    return 0;
+}
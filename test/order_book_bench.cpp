@@ -0,0 +1,162 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Update throughput of OrderBook at a realistic depth churn, compared with a node based book
+// (std::map per side), and the cost of the GET_BOOK snapshot. The stream keeps 10 levels per side
+// around a mid price that random walks by one tick, with a jump of 600 ticks every 100000 updates
+// to exercise recentering. 20% of the updates remove a level, levels that leave the 10 level window
+// when the mid price moves are removed like the exchange does.
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include <windows.h>    // before trading.h, included by order_book.h
+#include "order_book.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+constexpr double TICK = 0.25;
+constexpr int32_t DEPTH = 10;
+
+struct Update
+{
+    Side side_;
+    double price_;
+    int64_t size_;
+};
+
+std::vector<Update> makeStream(size_t n)
+{
+    std::mt19937 rng(3);
+    std::vector<Update> stream;
+    stream.reserve(n);
+    int64_t mid = 20000;    // ticks
+    for (size_t i = 0; stream.size() < n; ++i)
+    {
+        auto old_mid = mid;
+        if (i % 100000 == 99999)
+        {
+            mid += 600;
+        }
+        else if (rng() % 16 == 0)
+        {
+            mid += rng() % 2 ? 1 : -1;
+        }
+        for (int64_t level = 1; level <= DEPTH && mid != old_mid; ++level)
+        {
+            auto bid = old_mid - level;
+            auto ask = old_mid + level;
+            if (bid < mid - DEPTH || bid >= mid)
+            {
+                stream.push_back(Update{Side::Buy, (double)bid * TICK, 0});
+            }
+            if (ask > mid + DEPTH || ask <= mid)
+            {
+                stream.push_back(Update{Side::Sell, (double)ask * TICK, 0});
+            }
+        }
+        auto level = (int64_t)(rng() % DEPTH) + 1;
+        auto side = rng() % 2 ? Side::Buy : Side::Sell;
+        auto tick = side == Side::Buy ? mid - level : mid + level;
+        auto size = rng() % 5 == 0 ? 0 : (int64_t)(rng() % 200) + 1;
+        stream.push_back(Update{side, (double)tick * TICK, size});
+    }
+    stream.resize(n);
+    return stream;
+}
+
+// node based reference book
+struct MapBook
+{
+    std::map<double, int64_t, std::greater<double>> bids_;
+    std::map<double, int64_t> asks_;
+
+    void update(Side side, double price, int64_t size)
+    {
+        if (side == Side::Buy)
+        {
+            size > 0 ? (void)(bids_[price] = size) : (void)bids_.erase(price);
+        }
+        else
+        {
+            size > 0 ? (void)(asks_[price] = size) : (void)asks_.erase(price);
+        }
+    }
+
+    int snapshot(T2 *out, int max_quotes, DATE time) const
+    {
+        int n = 0;
+        for (auto iter = bids_.begin(); iter != bids_.end() && n < max_quotes / 2; ++iter)
+        {
+            out[n++] = T2{time, -(float)iter->first, (float)iter->second};
+        }
+        for (auto iter = asks_.begin(); iter != asks_.end() && n < max_quotes; ++iter)
+        {
+            out[n++] = T2{time, (float)iter->first, (float)iter->second};
+        }
+        return n;
+    }
+};
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    auto n = test::iterations(argc, argv, 10000000);
+    auto stream = makeStream(1 << 20);
+    auto mask = stream.size() - 1;
+
+    auto book = std::make_unique<OrderBook>(TICK);
+    MapBook map_book;
+    test::bench("OrderBook::update", n, [&](uint64_t i)
+    {
+        auto &u = stream[i & mask];
+        book->update(u.side_, u.price_, u.size_);
+    });
+    test::bench("std::map update", n, [&](uint64_t i)
+    {
+        auto &u = stream[i & mask];
+        map_book.update(u.side_, u.price_, u.size_);
+    });
+    std::printf("  %d price indices between the outer levels\n", book->span());
+
+    T2 quotes[20];
+    int filled = 0;
+    test::bench("OrderBook::snapshot 20 quotes", n / 100, [&](uint64_t)
+    {
+        filled = book->snapshot(quotes, 20, 0.);
+        test::doNotOptimize(quotes[0]);
+    });
+    std::printf("  %d quotes filled\n", filled);
+    test::bench("std::map snapshot 20 quotes", n / 100, [&](uint64_t)
+    {
+        filled = map_book.snapshot(quotes, 20, 0.);
+        test::doNotOptimize(quotes[0]);
+    });
+    return 0;
+}
@@ -0,0 +1,166 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// OrderBook behavior the GET_BOOK snapshot relies on: the scanned range shrinks again when outer levels
+// are removed, a short list keeps the inside market, a batch whose END was lost doesn't block readers
+// for good, and a reader never returns a copy torn by a concurrent batch.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <windows.h>    // before trading.h, included by order_book.h
+#include "order_book.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+constexpr double TICK = 0.25;
+
+void rangeShrinks()
+{
+    auto book = std::make_unique<OrderBook>(TICK);
+    book->update(Side::Buy, 100., 5);
+    book->update(Side::Sell, 100.25, 5);
+    CHECK(book->span() == 2);
+
+    // levels far from the touch come and go
+    book->update(Side::Buy, 90., 1);
+    book->update(Side::Sell, 110., 1);
+    CHECK(book->span() == 81);
+    book->update(Side::Buy, 90., 0);
+    CHECK(book->span() == 41);
+    book->update(Side::Sell, 110., 0);
+    CHECK(book->span() == 2);
+
+    // removing an inner level keeps the bounds
+    book->update(Side::Buy, 99.5, 3);
+    book->update(Side::Buy, 99.75, 3);
+    book->update(Side::Buy, 99.75, 0);
+    CHECK(book->span() == 4);
+
+    book->update(Side::Buy, 99.5, 0);
+    book->update(Side::Buy, 100., 0);
+    book->update(Side::Sell, 100.25, 0);
+    CHECK(book->span() == 0);
+    T2 quotes[4];
+    CHECK(book->snapshot(quotes, 4, 0.) == 0);
+}
+
+void insideFirst()
+{
+    auto book = std::make_unique<OrderBook>(TICK);
+    for (int i = 0; i < 10; ++i)
+    {
+        book->update(Side::Buy, 100. - i * TICK, 10 + i);
+        book->update(Side::Sell, 100.25 + i * TICK, 20 + i);
+    }
+
+    T2 quotes[5];
+    CHECK(book->snapshot(quotes, 5, 0.) == 5);
+    CHECK(quotes[0].fVal == -100.f && quotes[0].fVol == 10.f);
+    CHECK(quotes[1].fVal == 100.25f && quotes[1].fVol == 20.f);
+    CHECK(quotes[2].fVal == -99.75f && quotes[2].fVol == 11.f);
+    CHECK(quotes[3].fVal == 100.5f && quotes[3].fVol == 21.f);
+    CHECK(quotes[4].fVal == -99.5f);
+
+    T2 all[32];
+    CHECK(book->snapshot(all, 32, 0.) == 20);
+    CHECK(all[18].fVal == -97.75f && all[19].fVal == 102.5f);
+}
+
+void lostEnd()
+{
+    auto book = std::make_unique<OrderBook>(TICK);
+    T2 quotes[4];
+    book->begin();
+    book->update(Side::Buy, 100., 5);
+    // readers don't get a copy of an open batch
+    CHECK(book->snapshot(quotes, 4, 0.) == -1);
+
+    // the END was lost, the rebuild after the resubscription opens and closes a new batch
+    book->begin();
+    book->clear(Side::Buy);
+    book->update(Side::Buy, 99.75, 7);
+    book->end();
+    CHECK(book->snapshot(quotes, 4, 0.) == 1);
+    CHECK(quotes[0].fVal == -99.75f && quotes[0].fVol == 7.f);
+
+    // a stray END is ignored
+    book->end();
+    book->update(Side::Sell, 100., 2);
+    CHECK(book->snapshot(quotes, 4, 0.) == 2);
+}
+
+// every batch moves size between two bid levels, a consistent copy always adds up to TOTAL
+void noTornCopies()
+{
+    constexpr int64_t TOTAL = 1000;
+    auto book = std::make_unique<OrderBook>(TICK);
+    book->update(Side::Buy, 100., TOTAL / 2);
+    book->update(Side::Buy, 99.75, TOTAL / 2);
+
+    std::atomic_bool done{false};
+    std::thread writer([&]()
+    {
+        for (int64_t i = 0; i < 2000000; ++i)
+        {
+            auto x = i % (TOTAL - 1) + 1;
+            book->begin();
+            book->update(Side::Buy, 100., x);
+            book->update(Side::Buy, 99.75, TOTAL - x);
+            book->end();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t copies = 0;
+    uint64_t busy = 0;
+    T2 quotes[4];
+    while (!done.load(std::memory_order_acquire))
+    {
+        auto n = book->snapshot(quotes, 4, 0.);
+        if (n < 0)
+        {
+            ++busy;
+            continue;
+        }
+        CHECK(n == 2);
+        CHECK((int64_t)quotes[0].fVol + (int64_t)quotes[1].fVol == TOTAL);
+        ++copies;
+    }
+    writer.join();
+    std::printf("%llu consistent copies, %llu busy\n", (unsigned long long)copies, (unsigned long long)busy);
+}
+
+}   // namespace
+
+int main()
+{
+    rangeShrinks();
+    insideFirst();
+    lostEnd();
+    noTornCopies();
+    return 0;
+}
@@ -0,0 +1,105 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Cost of the order record paths of OrderPool: allocate and release of an order's slot, and the report
+// path of the R|API thread, which resolves the context handle and updates the order state in place.
+// Stale handles of released orders are resolved as well, they must be rejected as cheaply.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "order_pool.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint32_t LIVE = 256;      // orders open at a time
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    auto n = test::iterations(argc, argv, 10000000);
+
+    OrderPool orders(1000000);
+    std::vector<Order*> live(LIVE);
+    std::vector<uint32_t> handles(LIVE);
+    for (uint32_t i = 0; i < LIVE; ++i)
+    {
+        live[i] = orders.allocate();
+        handles[i] = live[i]->handle_.load(std::memory_order_relaxed);
+    }
+
+    // the oldest order is replaced by a new one, the pool runs at its steady state
+    test::bench("allocate + release", n, [&](uint64_t i)
+    {
+        auto slot = i % LIVE;
+        orders.release(live[slot]);
+        live[slot] = orders.allocate();
+        handles[slot] = live[slot]->handle_.load(std::memory_order_relaxed);
+    });
+
+    // reports arrive for the live orders in random order
+    std::mt19937 rng(1);
+    std::vector<uint32_t> sequence(4096);
+    for (auto &slot : sequence)
+    {
+        slot = rng() % LIVE;
+    }
+    test::bench("report: get + state_.update", n, [&](uint64_t i)
+    {
+        auto *order = orders.get(OrderPool::context(handles[sequence[i % sequence.size()]]));
+        order->state_.update([i](OrderState &state)
+        {
+            state.exec_qty_ = i;
+            state.status_ = OrderStatus::Open;
+        });
+    });
+    // what the report callbacks do, the slot can't be reused while they hold it
+    test::bench("report: pin + state_.update", n, [&](uint64_t i)
+    {
+        auto order = orders.pin(OrderPool::context(handles[sequence[i % sequence.size()]]));
+        order->state_.update([i](OrderState &state)
+        {
+            state.exec_qty_ = i;
+            state.status_ = OrderStatus::Open;
+        });
+    });
+
+    // handles of released orders, their slots were reused
+    std::vector<uint32_t> stale(handles);
+    for (uint32_t i = 0; i < LIVE; ++i)
+    {
+        orders.release(live[i]);
+        live[i] = orders.allocate();
+    }
+    uint64_t rejected = 0;
+    test::bench("report: stale handle", n, [&](uint64_t i)
+    {
+        rejected += orders.get(OrderPool::context(stale[sequence[i % sequence.size()]])) == nullptr;
+    });
+    std::printf("rejected %llu of %llu, %u slots for %u live orders, %llu recycled\n", (unsigned long long)rejected,
+        (unsigned long long)n, orders.size(), orders.live(), (unsigned long long)orders.recycled());
+    return 0;
+}
@@ -0,0 +1,222 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Soak test of the order store of a multi-week session: millions of orders with random lifetimes go
+// through OrderPool the way sends and retireOrders use it. The number of records must stay flat at the
+// peak number of live orders plus the reuse delay, live handles must resolve to their own order and the
+// handles of recently released orders must be rejected, like a late report for a recycled slot.
+// A small pool is then run at its capacity, where released slots are reused without the delay.
+// Finally report threads pin orders while they are released and reused, a pinned record must never
+// be reset or handed to another order under them.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+#include "order_pool.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint32_t MAX_LIFETIME = 2000;     // orders sent before an order is retired
+constexpr uint32_t STALE = 4096;            // most recently released handles that are checked
+
+struct Live
+{
+    uint64_t retire_at_;
+    uint32_t handle_;
+    uint32_t order_num_;
+    bool operator>(const Live &other) const noexcept { return retire_at_ > other.retire_at_; }
+};
+
+void soak(uint64_t n)
+{
+    OrderPool orders(1000000);
+    std::priority_queue<Live, std::vector<Live>, std::greater<>> live;
+    std::vector<uint32_t> stale(STALE, 0);
+    std::mt19937 rng(1);
+    uint32_t peak = 0;
+    uint32_t max_size = 0;
+
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        auto *order = orders.allocate();
+        CHECK(order);
+        auto handle = order->handle_.load(std::memory_order_relaxed);
+        CHECK(orders.get(OrderPool::context(handle)) == order);
+        CHECK(order->state_.load().order_num_ == 0);
+        order->state_.update([i](OrderState &state) { state.order_num_ = (uint32_t)i + 1; });
+        live.push(Live{i + 1 + rng() % MAX_LIFETIME, handle, (uint32_t)i + 1});
+        peak = std::max(peak, orders.live());
+
+        while (!live.empty() && live.top().retire_at_ <= i)
+        {
+            auto retired = live.top();
+            live.pop();
+            auto *done = orders.get(retired.handle_);
+            CHECK(done);
+            CHECK(done->state_.load().order_num_ == retired.order_num_);
+            orders.release(done);
+            CHECK(!orders.get(retired.handle_));
+            stale[i % STALE] = retired.handle_;
+        }
+
+        // a late report for a released order
+        auto late = stale[rng() % STALE];
+        CHECK(!late || !orders.get(OrderPool::context(late)));
+        max_size = std::max(max_size, orders.size());
+    }
+
+    std::printf("%llu orders, peak %u live, %u records, %llu recycled\n", (unsigned long long)n, peak, max_size,
+        (unsigned long long)orders.recycled());
+    CHECK(max_size <= peak + OrderPool::REUSE_DELAY + 1);
+    CHECK(orders.live() == live.size());
+}
+
+void atCapacity()
+{
+    constexpr uint32_t CAPACITY = 64;
+    OrderPool orders(CAPACITY);
+    std::vector<Order*> live;
+    for (uint32_t i = 0; i < CAPACITY; ++i)
+    {
+        live.push_back(orders.allocate());
+        CHECK(live.back());
+    }
+    CHECK(!orders.allocate());
+
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        auto &slot = live[i % CAPACITY];
+        auto handle = slot->handle_.load(std::memory_order_relaxed);
+        orders.release(slot);
+        slot = orders.allocate();
+        CHECK(slot);
+        CHECK(!orders.get(handle));
+        CHECK(!orders.allocate());
+    }
+    CHECK(orders.size() == CAPACITY);
+}
+
+void pinned()
+{
+    // a report that resolved its handle before the order was released
+    OrderPool orders(1000000);
+    auto *order = orders.allocate();
+    auto handle = order->handle_.load(std::memory_order_relaxed);
+    order->client_order_id_ = 42;
+    {
+        auto pin = orders.pin(OrderPool::context(handle));
+        CHECK(pin == order);
+        orders.release(order);
+        CHECK(!orders.pin(handle));
+        for (uint32_t i = 0; i < 4 * OrderPool::REUSE_DELAY; ++i)
+        {
+            auto *other = orders.allocate();
+            CHECK(other != order);
+            orders.release(other);
+        }
+        CHECK(order->client_order_id_ == 42);
+        CHECK(!order->handle_.load(std::memory_order_relaxed));
+    }
+
+    // unpinned, the slot comes back once its turn in the free list arrives
+    bool reused = false;
+    for (uint32_t i = 0; i < 4 * OrderPool::REUSE_DELAY && !reused; ++i)
+    {
+        auto *other = orders.allocate();
+        reused = other == order;
+        orders.release(other);
+    }
+    CHECK(reused);
+}
+
+void lateReports(uint64_t n)
+{
+    constexpr unsigned REPORTERS = 2;
+    OrderPool orders(4096);
+    std::atomic<uint64_t> current{0};     // client_order_id << 32 | handle of the newest order
+    std::atomic_bool done{false};
+    std::atomic<uint64_t> pinned{0};
+
+    std::vector<std::thread> reporters;
+    for (unsigned r = 0; r < REPORTERS; ++r)
+    {
+        reporters.emplace_back([&]()
+        {
+            uint64_t count = 0;
+            while (!done.load(std::memory_order_acquire))
+            {
+                auto value = current.load(std::memory_order_acquire);
+                auto order = orders.pin((uint32_t)value);
+                if (!order)
+                {
+                    continue;
+                }
+                ++count;
+                for (int i = 0; i < 16; ++i)
+                {
+                    CHECK(order->client_order_id_ == value >> 32);
+                }
+            }
+            pinned.fetch_add(count, std::memory_order_relaxed);
+        });
+    }
+
+    std::vector<Order*> live(8, nullptr);
+    for (uint64_t i = 1; i <= n; ++i)
+    {
+        auto &slot = live[i % live.size()];
+        if (slot)
+        {
+            orders.release(slot);
+        }
+        slot = orders.allocate();
+        CHECK(slot);
+        slot->client_order_id_ = i;
+        current.store(i << 32 | slot->handle_.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto &reporter : reporters)
+    {
+        reporter.join();
+    }
+    std::printf("%llu orders, %llu pinned reports, %llu recycled\n", (unsigned long long)n,
+        (unsigned long long)pinned.load(), (unsigned long long)orders.recycled());
+}
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    soak(test::iterations(argc, argv, 5000000));
+    atCapacity();
+    pinned();
+    lateReports(1000000);
+    return 0;
+}
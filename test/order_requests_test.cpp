@@ -0,0 +1,264 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Concurrency stress test of the per-order request tracking. Sender, canceller and replay threads
+// issue overlapping requests on the same orders through waitOrder() while a stand-in for the R|API
+// thread answers them out of order through completeOrder(), the way the report callbacks do.
+// Every wait that returns Done must see the report it waited for, and no request may be left behind.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "order_pool.h"
+#include "order_wait.h"
+#include "test_util.h"
+
+namespace zorro {
+int(__cdecl* BrokerProgress)(const int percent) = [](const int) { return 1; };
+}
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint32_t SENDERS = 2;
+constexpr uint32_t ORDERS_PER_SENDER = 20000;
+constexpr uint32_t CANCELLERS = 2;
+constexpr uint32_t REPLAYERS = 2;
+constexpr uint32_t RECENT = 64;             // orders the cancel and replay threads pick from
+constexpr uint64_t SEND_TIMEOUT_MS = 20;
+constexpr uint32_t DROP_EVERY = 97;         // sends the engine never acknowledges
+
+struct Request
+{
+    uint32_t handle_;
+    OrderRequest request_;
+};
+
+/**
+ * @brief Stand-in for the R|API thread, the only writer of the order state. It answers the queued
+ * requests in a shuffled order and drops some sends, so their senders time out.
+ */
+class Engine
+{
+    OrderPool &orders_;
+    Waiter &waiter_;
+    std::mutex mutex_;
+    std::deque<Request> requests_;
+    std::atomic_bool stop_{false};
+    std::thread thread_;
+    uint32_t next_order_num_ = 1;
+
+public:
+    uint64_t sends_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t cancels_ = 0;
+    uint64_t replays_ = 0;
+
+    Engine(OrderPool &orders, Waiter &waiter) : orders_(orders), waiter_(waiter), thread_([this]() { run(); }) {}
+
+    void stop()
+    {
+        stop_.store(true, std::memory_order_relaxed);
+        thread_.join();
+    }
+
+    void post(uint32_t handle, OrderRequest request)
+    {
+        std::lock_guard lock(mutex_);
+        requests_.push_back(Request{handle, request});
+    }
+
+private:
+    void run()
+    {
+        std::mt19937 rng(7);
+        std::vector<Request> batch;
+        while (true)
+        {
+            {
+                std::lock_guard lock(mutex_);
+                batch.assign(requests_.begin(), requests_.end());
+                requests_.clear();
+            }
+            if (batch.empty())
+            {
+                if (stop_.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::shuffle(batch.begin(), batch.end(), rng);
+            for (auto &request : batch)
+            {
+                answer(request);
+            }
+        }
+    }
+
+    void answer(const Request &request)
+    {
+        auto order = orders_.pin(request.handle_);
+        CHECK(order);
+        switch (request.request_)
+        {
+        case or_Send:
+            if (++sends_ % DROP_EVERY == 0)
+            {
+                ++dropped_;
+                return;
+            }
+            order->state_.update([this](OrderState &state)
+            {
+                state.order_num_ = next_order_num_++;
+                state.status_ = OrderStatus::Open;
+            });
+            completeOrder(waiter_, order, or_Send);
+            break;
+        case or_Cancel:
+            ++cancels_;
+            order->state_.update([](OrderState &state) { state.cancelled_ = true; });
+            // a cancel report also completes a send that is still waiting for its acknowledgement
+            completeOrder(waiter_, order, or_Send | or_Cancel);
+            break;
+        case or_Replay:
+            ++replays_;
+            // the number of replays answered for the order
+            order->detail_.update([](OrderDetail &detail) { ++detail.last_update_time_; });
+            completeOrder(waiter_, order, or_Replay);
+            break;
+        }
+    }
+};
+
+}   // namespace
+
+int main()
+{
+    OrderPool orders(SENDERS * ORDERS_PER_SENDER);
+    Waiter waiter;
+    waiter.configure(200, 20, 1);
+    Engine engine(orders, waiter);
+
+    std::array<std::atomic<uint32_t>, RECENT> recent{};
+    std::atomic<uint32_t> senders_running{SENDERS};
+    std::atomic<uint64_t> send_timeouts{0};
+    std::atomic<uint64_t> cancels_done{0};
+    std::atomic<uint64_t> replays_done{0};
+
+    std::vector<std::thread> threads;
+    for (uint32_t s = 0; s < SENDERS; ++s)
+    {
+        threads.emplace_back([&, s]()
+        {
+            for (uint32_t i = 0; i < ORDERS_PER_SENDER; ++i)
+            {
+                auto *order = orders.allocate();
+                CHECK(order);
+                auto handle = order->handle_.load(std::memory_order_relaxed);
+                // visible to the other threads while the send is still in flight
+                recent[(s * ORDERS_PER_SENDER + i) % RECENT].store(handle, std::memory_order_release);
+
+                order->requests_.fetch_or(or_Send, std::memory_order_release);
+                engine.post(handle, or_Send);
+                auto result = waitOrder(waiter, order, or_Send, WaitSite::SendOrder, SEND_TIMEOUT_MS);
+                CHECK(result != WaitResult::Aborted);
+                if (result == WaitResult::Done)
+                {
+                    auto state = order->state_.load();
+                    CHECK(state.order_num_ || state.cancelled_);
+                }
+                else
+                {
+                    send_timeouts.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            senders_running.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    // cancels and replays wait without a timeout, as in RithmicClient
+    auto overlap = [&](OrderRequest request, uint32_t seed, std::atomic<uint64_t> &done)
+    {
+        std::mt19937 rng(seed);
+        while (senders_running.load(std::memory_order_acquire))
+        {
+            auto handle = recent[rng() % RECENT].load(std::memory_order_acquire);
+            auto *order = orders.get(handle);
+            if (!order)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            auto replays = order->detail_.load().last_update_time_;
+            order->requests_.fetch_or(request, std::memory_order_release);
+            engine.post(handle, request);
+            CHECK(waitOrder(waiter, order, request, request == or_Cancel ? WaitSite::CancelOrder : WaitSite::RetrieveOrder) == WaitResult::Done);
+            if (request == or_Cancel)
+            {
+                CHECK(order->state_.load().cancelled_);
+            }
+            else
+            {
+                CHECK(order->detail_.load().last_update_time_ > replays);
+            }
+            done.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    for (uint32_t c = 0; c < CANCELLERS; ++c)
+    {
+        threads.emplace_back(overlap, or_Cancel, 100 + c, std::ref(cancels_done));
+    }
+    for (uint32_t r = 0; r < REPLAYERS; ++r)
+    {
+        threads.emplace_back(overlap, or_Replay, 200 + r, std::ref(replays_done));
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    engine.stop();
+
+    // every request was either completed by its report or withdrawn by a failed wait
+    for (uint32_t i = 0; i < orders.size(); ++i)
+    {
+        CHECK(orders.at(i)->requests_.load(std::memory_order_relaxed) == 0);
+    }
+    CHECK(send_timeouts.load() <= engine.dropped_);
+    CHECK(engine.sends_ == SENDERS * ORDERS_PER_SENDER);
+    CHECK(cancels_done.load() > 0 && replays_done.load() > 0);
+
+    std::printf("%llu sends (%llu dropped, %llu timed out), %llu cancels, %llu replays\n", (unsigned long long)engine.sends_,
+        (unsigned long long)engine.dropped_, (unsigned long long)send_timeouts.load(), (unsigned long long)cancels_done.load(),
+        (unsigned long long)replays_done.load());
+    return 0;
+}
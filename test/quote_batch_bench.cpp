@@ -0,0 +1,153 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Cost of reading the quotes of a portfolio. BrokerAsset resolves every asset by name in the symbol map
+// before it loads the top of book, the batched GET_QUOTES (2013) indexes the contiguous symbol storage
+// with the handles kept in the caller's QuoteRecord array. The Zorro call per asset that the batch also
+// saves is not part of the numbers.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "broker_commands.h"
+#include "seqlock.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint32_t SYMBOLS = 100;
+constexpr uint32_t PORTFOLIO = 20;
+
+// the size of MDTop
+struct Top
+{
+    double bid_;
+    double ask_;
+    int64_t bid_qty_;
+    int64_t ask_qty_;
+    double mid_;
+    double micro_;
+    uint64_t seq_;
+};
+
+// stands in for Symbol, which is several cache lines long
+struct Slot
+{
+    std::string symbol_;
+    SeqLock<Top> top_;
+    char payload_[896] = {};
+};
+
+struct StringHash
+{
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+
+std::vector<Slot> slots(SYMBOLS);
+std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> handles;
+
+void readQuote(const Slot &slot, double *price, double *spread, double *volume)
+{
+    auto top = slot.top_.load();
+    *price = !std::isnan(top.mid_) ? top.mid_ : top.ask_;
+    *spread = !std::isnan(top.bid_) ? top.ask_ - top.bid_ : 0.;
+    *volume = (double)(top.bid_qty_ + top.ask_qty_);
+}
+
+// BrokerAsset, once per asset
+int brokerAsset(const char *asset, double *price, double *spread, double *volume)
+{
+    auto iter = handles.find(std::string_view(asset));
+    if (iter == handles.end())
+    {
+        return 0;
+    }
+    readQuote(slots[iter->second], price, spread, volume);
+    return 1;
+}
+
+// GET_QUOTES after the first call, every handle is known
+int getQuotes(QuoteQuery &query)
+{
+    int n_ready = 0;
+    for (int i = 0; i < query.n_quotes; ++i)
+    {
+        auto &quote = query.quotes[i];
+        if ((uint32_t)quote.handle >= SYMBOLS)
+        {
+            quote.ready = 0;
+            continue;
+        }
+        readQuote(slots[quote.handle], &quote.price, &quote.spread, &quote.volume);
+        quote.ready = 1;
+        ++n_ready;
+    }
+    return n_ready;
+}
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    auto n = test::iterations(argc, argv, 2000000);
+
+    for (uint32_t i = 0; i < SYMBOLS; ++i)
+    {
+        slots[i].symbol_ = "SYM" + std::to_string(i) + "Z5.CME";
+        slots[i].top_.store(Top{100. + i, 100.25 + i, 10, 12, 100.125 + i, 100.13 + i, i});
+        handles.emplace(slots[i].symbol_, i);
+    }
+
+    // every fifth symbol of the universe
+    std::vector<QuoteRecord> quotes(PORTFOLIO);
+    for (uint32_t i = 0; i < PORTFOLIO; ++i)
+    {
+        quotes[i] = QuoteRecord{};
+        quotes[i].asset = slots[i * 5].symbol_.data();
+        quotes[i].handle = (int)(i * 5);
+    }
+    QuoteQuery query{quotes.data(), (int)quotes.size()};
+
+    std::printf("%u of %u symbols per call\n", PORTFOLIO, SYMBOLS);
+    test::bench("BrokerAsset per asset (map lookup)", n, [&](uint64_t)
+    {
+        double price, spread, volume, sum = 0.;
+        for (auto &quote : quotes)
+        {
+            brokerAsset(quote.asset, &price, &spread, &volume);
+            sum += price;
+        }
+        test::doNotOptimize(sum);
+    });
+    test::bench("GET_QUOTES batch (handles)", n, [&](uint64_t)
+    {
+        test::doNotOptimize(getQuotes(query));
+    });
+    return 0;
+}
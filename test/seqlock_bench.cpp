@@ -0,0 +1,124 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Writer and reader throughput of SeqLock under contention, compared with std::atomic<T>, which is
+// not lock-free for a snapshot of this size and takes a hidden lock. The writer stores as fast as
+// it can while the readers load, both sides report their cost per operation.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "seqlock.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+// the size of MDTop
+struct Top
+{
+    double bid_;
+    double ask_;
+    int64_t bid_qty_;
+    int64_t ask_qty_;
+    double mid_;
+    double micro_;
+    uint64_t seq_;
+};
+
+struct SeqLockTop
+{
+    SeqLock<Top> top_;
+    void store(const Top &top) noexcept { top_.store(top); }
+    Top load() const noexcept { return top_.load(); }
+};
+
+struct AtomicTop
+{
+    std::atomic<Top> top_;
+    void store(const Top &top) noexcept { top_.store(top, std::memory_order_release); }
+    Top load() const noexcept { return top_.load(std::memory_order_acquire); }
+};
+
+template<typename Snapshot>
+void run(const char *name, uint64_t stores, unsigned readers)
+{
+    Snapshot snapshot;
+    std::atomic_bool done{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> read_ns{0};
+
+    std::vector<std::thread> threads;
+    for (unsigned r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&]()
+        {
+            uint64_t n = 0;
+            double sum = 0.;
+            auto start = test::nowNs();
+            while (!done.load(std::memory_order_relaxed))
+            {
+                auto top = snapshot.load();
+                sum += top.bid_;
+                ++n;
+            }
+            test::doNotOptimize(sum);
+            read_ns.fetch_add(test::nowNs() - start, std::memory_order_relaxed);
+            reads.fetch_add(n, std::memory_order_relaxed);
+        });
+    }
+
+    Top top{};
+    auto start = test::nowNs();
+    for (uint64_t k = 0; k < stores; ++k)
+    {
+        top.bid_ = (double)k;
+        top.seq_ = k;
+        snapshot.store(top);
+    }
+    auto write_ns = test::nowNs() - start;
+    done.store(true, std::memory_order_relaxed);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::printf("%-10s %u readers: store %6.1f ns, load %6.1f ns, %6.1f M loads/s per reader\n", name, readers,
+        (double)write_ns / (double)stores, (double)read_ns.load() / (double)reads.load(),
+        (double)reads.load() / readers / ((double)write_ns / 1e3));
+}
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    auto stores = test::iterations(argc, argv, 20000000);
+    std::printf("std::atomic<Top> lock-free: %d\n", (int)std::atomic<Top>{}.is_lock_free());
+    for (unsigned readers : {1u, 3u})
+    {
+        run<SeqLockTop>("SeqLock", stores, readers);
+        run<AtomicTop>("atomic", stores, readers);
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Torn read stress test of SeqLock: one writer publishes snapshots whose words all carry the store
+// count while reader threads check every copy they get is whole and belongs to the sequence number
+// returned with it.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "seqlock.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+// the size of MDTop
+struct Wide
+{
+    uint64_t words_[7];
+};
+
+// not a multiple of 8 bytes, the last storage word is partly used
+struct Narrow
+{
+    uint32_t words_[9];
+};
+
+template<typename T>
+using Word = std::remove_cvref_t<decltype(T{}.words_[0])>;
+
+template<typename T>
+T make(uint64_t count) noexcept
+{
+    T value;
+    for (auto &word : value.words_)
+    {
+        word = static_cast<Word<T>>(count);
+    }
+    return value;
+}
+
+template<typename T>
+void stress(const char *name, uint64_t duration_ms, unsigned readers)
+{
+    SeqLock<T> lock;
+    std::atomic<unsigned> started{0};
+    std::atomic_bool done{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> snapshots{0};    // distinct stores seen by the readers
+
+    std::vector<std::thread> threads;
+    for (unsigned r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&]()
+        {
+            started.fetch_add(1, std::memory_order_relaxed);
+            uint64_t last_seq = 0;
+            uint64_t n = 0;
+            uint64_t changed = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                uint64_t seq;
+                auto value = lock.load(seq);
+                ++n;
+                CHECK(!(seq & 1));
+                CHECK(seq >= last_seq);
+                changed += seq != last_seq;
+                last_seq = seq;
+
+                // the constructor stored count 0 with sequence 2, store k has sequence 2k + 2
+                auto count = static_cast<Word<T>>(seq / 2 - 1);
+                for (auto word : value.words_)
+                {
+                    CHECK(word == count);
+                }
+            }
+            reads.fetch_add(n, std::memory_order_relaxed);
+            snapshots.fetch_add(changed, std::memory_order_relaxed);
+        });
+    }
+
+    while (started.load(std::memory_order_relaxed) < readers)
+    {
+        std::this_thread::yield();
+    }
+
+    // the clock is only read every 1024 stores to keep the writer busy storing
+    uint64_t stores = 0;
+    auto end = test::nowNs() + duration_ms * 1000000;
+    do
+    {
+        for (uint32_t i = 0; i < 1024; ++i)
+        {
+            lock.store(make<T>(++stores));
+        }
+    } while (test::nowNs() < end);
+    done.store(true, std::memory_order_relaxed);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(lock.sequence() == 2 * stores + 2);
+    auto last = lock.load();
+    CHECK(last.words_[0] == static_cast<Word<T>>(stores));
+    CHECK(snapshots.load() > readers);
+    std::printf("%s: %llu stores, %u readers, %llu reads, %llu distinct snapshots read\n", name, (unsigned long long)stores, readers,
+        (unsigned long long)reads.load(), (unsigned long long)snapshots.load());
+}
+
+}   // namespace
+
+int main()
+{
+    auto readers = std::max(2u, std::thread::hardware_concurrency() - 1);
+    stress<Wide>("Wide", 1000, readers);
+    stress<Narrow>("Narrow", 1000, readers);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// The few Win32 calls waiter.h makes, mapped to Linux so the tests that include it build there,
+// and the handle types Zorro's trading.h declares fields of. Only used when the tests are not built on Windows.
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <thread>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define __cdecl
+
+typedef int BOOL;
+typedef uint32_t DWORD;
+typedef void* HANDLE;
+typedef void* HINSTANCE;
+typedef void* HWND;
+
+struct FILETIME
+{
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+};
+
+inline HANDLE GetCurrentThread() noexcept { return nullptr; }
+
+// the CPU time of the calling thread is reported as user time, in 100 ns units
+inline BOOL GetThreadTimes(HANDLE, FILETIME *creation, FILETIME *exit, FILETIME *kernel, FILETIME *user) noexcept
+{
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+    {
+        return 0;
+    }
+    auto t = ((uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec) / 100;
+    *creation = *exit = *kernel = FILETIME{0, 0};
+    *user = FILETIME{(DWORD)t, (DWORD)(t >> 32)};
+    return 1;
+}
+
+inline void YieldProcessor() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+inline BOOL SwitchToThread() noexcept
+{
+    std::this_thread::yield();
+    return 1;
+}
+
+// waiter.h only waits on 32-bit words
+inline BOOL WaitOnAddress(volatile void *address, void *compare, size_t, DWORD ms) noexcept
+{
+    timespec ts{(time_t)(ms / 1000), (long)(ms % 1000) * 1000000};
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, *static_cast<uint32_t*>(compare), &ts, nullptr, 0);
+    return 1;
+}
+
+inline void WakeByAddressAll(void *address) noexcept
+{
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
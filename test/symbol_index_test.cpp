@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// SymbolIndex lookups while the writer inserts: every published handle is found under its own name,
+// and names not inserted yet are never resolved to another handle.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "symbol_index.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint32_t N = 8000;    // MAX_ASSETS
+
+}   // namespace
+
+int main()
+{
+    std::vector<std::string> names(N);
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        names[i] = "SYM" + std::to_string(i) + "Z5.CME";
+    }
+    auto name_of = [&](uint32_t h) -> const std::string& { return names[h]; };
+
+    SymbolIndex<N> index;
+    std::atomic_uint32_t published{0};
+    std::atomic_bool done{false};
+    std::atomic<uint64_t> lookups{0};
+
+    std::thread reader([&]()
+    {
+        uint64_t count = 0;
+        uint32_t i = 0;
+        while (!done.load(std::memory_order_acquire))
+        {
+            auto n = published.load(std::memory_order_acquire);
+            auto handle = index.find(names[i], name_of);
+            if (i < n)
+            {
+                CHECK(handle == i);
+            }
+            else
+            {
+                CHECK(handle == i || handle == index.INVALID);
+            }
+            i = (i + 1) % N;
+            ++count;
+        }
+        lookups.store(count, std::memory_order_relaxed);
+    });
+
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        index.insert(names[i], i);
+        published.store(i + 1, std::memory_order_release);
+        if (i % 64 == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        CHECK(index.find(names[i], name_of) == i);
+    }
+    CHECK(index.find("SYM8000Z5.CME", name_of) == index.INVALID);
+    CHECK(index.find("", name_of) == index.INVALID);
+
+    std::printf("symbol_index_test: %u symbols, %llu concurrent lookups ok\n", N, (unsigned long long)lookups.load());
+    return 0;
+}
@@ -0,0 +1,127 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Cost of resolving the symbol of a market data callback. The callbacks used to format "TICKER.EXCH"
+// into a std::string and hash it into a map, they now check the subscription context against the
+// contiguous symbol array. Callbacks without a context format the name on the stack and look it up in
+// the SymbolIndex of the published symbols (RithmicClient::findSymbol), which replaced a linear scan.
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "symbol_index.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+namespace {
+
+constexpr uint32_t SYMBOLS = 100;
+
+// stands in for Symbol, which is several cache lines long
+struct Slot
+{
+    std::string symbol_;
+    char payload_[960] = {};
+};
+
+// the fields of an R|API info struct the lookup reads
+struct Info
+{
+    std::string_view sTicker;
+    std::string_view sExchange;
+};
+
+std::array<Slot, SYMBOLS> slots;
+std::unordered_map<std::string, Slot*> by_name;
+SymbolIndex<SYMBOLS> by_index;
+
+Slot* formatAndHash(const Info &info)
+{
+    auto iter = by_name.find(std::format("{}.{}", info.sTicker, info.sExchange));
+    return iter != by_name.end() ? iter->second : nullptr;
+}
+
+Slot* fromContext(void *context)
+{
+    auto *slot = static_cast<Slot*>(context);
+    return slot >= slots.data() && slot < slots.data() + slots.size() ? slot : nullptr;
+}
+
+Slot* formatAndScan(const Info &info)
+{
+    char buf[64];
+    auto result = std::format_to_n(buf, sizeof(buf), "{}.{}", info.sTicker, info.sExchange);
+    std::string_view name(buf, result.out);
+    for (auto &slot : slots)
+    {
+        if (slot.symbol_ == name)
+        {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+Slot* formatAndIndex(const Info &info)
+{
+    char buf[64];
+    auto result = std::format_to_n(buf, sizeof(buf), "{}.{}", info.sTicker, info.sExchange);
+    auto handle = by_index.find(std::string_view(buf, result.out), [](uint32_t h) -> const std::string& { return slots[h].symbol_; });
+    return handle != by_index.INVALID ? &slots[handle] : nullptr;
+}
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    auto n = test::iterations(argc, argv, 10000000);
+
+    std::vector<std::string> tickers(SYMBOLS);
+    for (uint32_t i = 0; i < SYMBOLS; ++i)
+    {
+        tickers[i] = std::format("SYM{}Z5", i);
+        slots[i].symbol_ = tickers[i] + ".CME";
+        by_name.emplace(slots[i].symbol_, &slots[i]);
+        by_index.insert(slots[i].symbol_, i);
+    }
+
+    // a random callback sequence across the universe
+    std::mt19937 rng(1);
+    std::vector<uint32_t> sequence(4096);
+    for (auto &idx : sequence)
+    {
+        idx = rng() % SYMBOLS;
+    }
+    auto info = [&](uint64_t i) { return Info{tickers[sequence[i % sequence.size()]], "CME"}; };
+
+    test::bench("format + unordered_map (before)", n, [&](uint64_t i) { test::doNotOptimize(formatAndHash(info(i))); });
+    test::bench("context handle", n, [&](uint64_t i) { test::doNotOptimize(fromContext(&slots[sequence[i % sequence.size()]])); });
+    test::bench("stack format + scan (no context, before)", n, [&](uint64_t i) { test::doNotOptimize(formatAndScan(info(i))); });
+    test::bench("stack format + index (no context)", n, [&](uint64_t i) { test::doNotOptimize(formatAndIndex(info(i))); });
+    return 0;
+}
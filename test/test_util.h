@@ -0,0 +1,80 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Checks that stay active in Release builds, a failure exits with 1 so ctest reports it.
+#define CHECK(cond)                                                                         \
+    do                                                                                      \
+    {                                                                                       \
+        if (!(cond))                                                                        \
+        {                                                                                   \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);  \
+            std::exit(1);                                                                   \
+        }                                                                                   \
+    } while (0)
+
+namespace zorro::test {
+
+inline uint64_t nowNs() noexcept
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Iteration count of a benchmark, the first command line argument or the default.
+ */
+inline uint64_t iterations(int argc, char *argv[], uint64_t default_count) noexcept
+{
+    return argc > 1 ? std::strtoull(argv[1], nullptr, 10) : default_count;
+}
+
+/**
+ * @brief Time n calls of fn and print the mean cost per call.
+ */
+template<typename Fn>
+double bench(const char *name, uint64_t n, Fn &&fn)
+{
+    auto start = nowNs();
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        fn(i);
+    }
+    auto ns = (double)(nowNs() - start) / (double)n;
+    std::printf("%-40s %10.1f ns/op\n", name, ns);
+    return ns;
+}
+
+inline volatile char sink_;
+
+// keeps the compiler from dropping a benchmarked result
+template<typename T>
+inline void doNotOptimize(const T &value) noexcept
+{
+    sink_ = *reinterpret_cast<const volatile char*>(&value);
+}
+
+}   // namespace zorro::test
@@ -0,0 +1,73 @@
+// The MIT License (MIT)
+// Copyright (c) 2024-2025 Kun Zhao
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tick recorder at peak tick rates. The producer records bid/ask and trade ticks of 100 assets
+// as fast as it can, across a UTC day boundary so every file rolls once. Reports the cost of
+// record() on the market data thread, the ticks per second the recorder thread maps to disk and
+// the ticks dropped because its queue was full.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include "tick_recorder.h"
+#include "test_util.h"
+
+using namespace zorro;
+
+int main(int argc, char *argv[])
+{
+    constexpr uint32_t assets = 100;
+    constexpr DATE day = 45500.;            // a UTC day as OLE DATE
+    auto n = test::iterations(argc, argv, 20000000);
+
+    auto dir = (std::filesystem::temp_directory_path() / "tick_recorder_bench").string();
+    std::filesystem::remove_all(dir);
+    {
+        TickRecorder recorder(dir, [](uint32_t handle) { return "BENCH" + std::to_string(handle); });
+        recorder.start();
+
+        auto start = test::nowNs();
+        test::bench("TickRecorder::record", n, [&](uint64_t i)
+        {
+            // the second half of the ticks falls on the next day
+            auto time = day + (i >= n / 2 ? 1. : 0.) + 0.5 * (double)i / (double)n;
+            auto handle = (uint32_t)(i % assets);
+            if (i % 4 == 3)
+            {
+                recorder.record(handle, TickRecorder::Type::T1, time, 5000.25f, 1.f);
+            }
+            else
+            {
+                recorder.record(handle, TickRecorder::Type::T2, time, i % 2 ? 5000.25f : -5000.f, 10.f);
+            }
+        });
+        recorder.stop();
+        auto seconds = (double)(test::nowNs() - start) / 1e9;
+
+        std::printf("%llu ticks recorded in %.2f s (%.1f M ticks/s), %llu dropped, %llu files\n",
+            (unsigned long long)recorder.records(), seconds, (double)recorder.records() / seconds / 1e6,
+            (unsigned long long)recorder.dropped(), (unsigned long long)recorder.filesOpened());
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}